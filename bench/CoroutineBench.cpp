@@ -0,0 +1,140 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Coroutine.hpp"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#define CLIENTS        32
+#define REQUESTS       25
+#define FRONT_WORKERS  2
+#define BACK_WORKERS   32
+
+/**
+ * @brief Downstream service with a fixed latency per job.
+ */
+class Backend : public NSA::Service
+{
+public:
+    Backend() : Service("Backend service")
+    {}
+
+    Service::Future<int> fetch(const int key)
+    {
+        NSA_MAKE_PROMISE(Backend::fetchImp, int, key);
+    }
+
+private:
+    void fetchImp(Service::Promise<int> promise, const int key)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+        promise->set_value(key);
+    }
+};
+
+/**
+ * @brief Front service which blocks its worker on the backend.
+ */
+class BlockingFront : public NSA::Service
+{
+public:
+    BlockingFront(Backend &backend) : Service("Blocking front service"), backend(backend)
+    {
+        jobTimeOut(std::chrono::milliseconds(60000));
+    }
+
+    Service::Future<int> handle(const int key)
+    {
+        NSA_MAKE_PROMISE(BlockingFront::handleImp, int, key);
+    }
+
+private:
+    void handleImp(Service::Promise<int> promise, const int key)
+    {
+        promise->set_value(backend.fetch(key)->get() + 1);
+    }
+
+    Backend &backend;
+};
+
+/**
+ * @brief Front service which suspends on the backend.
+ */
+class CoroutineFront : public NSA::Service
+{
+public:
+    CoroutineFront(Backend &backend) : Service("Coroutine front service"), backend(backend)
+    {
+        jobTimeOut(std::chrono::milliseconds(60000));
+    }
+
+    Service::Future<int> handle(const int key)
+    {
+        co_return co_await backend.fetch(key) + 1;
+    }
+
+private:
+    Backend &backend;
+};
+
+/**
+ * @brief Lets CLIENTS threads call the front service at the same time.
+ * @return The wall clock time of all requests in milliseconds.
+ */
+template <class Front>
+double run(Front &front)
+{
+    std::vector<std::thread> clients;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int c = 0; c < CLIENTS; c++)
+        clients.push_back(std::thread([&front, c]()
+        {
+            for (int r = 0; r < REQUESTS; r++)
+                front.handle(c * REQUESTS + r)->get();
+        }));
+
+    for (std::thread &client : clients)
+        client.join();
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    Backend backend;
+    BlockingFront blocking(backend);
+    CoroutineFront coroutine(backend);
+
+    backend.detach(BACK_WORKERS);
+    blocking.detach(FRONT_WORKERS);
+    coroutine.detach(FRONT_WORKERS);
+
+    const double blockingTime = run(blocking);
+    const double coroutineTime = run(coroutine);
+    const int requests = CLIENTS * REQUESTS;
+
+    printf("%d clients, %d front workers, %d backend workers, %d requests\n",
+        CLIENTS, FRONT_WORKERS, BACK_WORKERS, requests);
+    printf("%-10s %10s %12s\n", "chain", "time [ms]", "requests/s");
+    printf("%-10s %10.1f %12.0f\n", "blocking", blockingTime, requests / blockingTime * 1000.0);
+    printf("%-10s %10.1f %12.0f\n", "coroutine", coroutineTime, requests / coroutineTime * 1000.0);
+
+    coroutine.join();
+    blocking.join();
+    backend.join();
+
+    return EXIT_SUCCESS;
+}
+
+#else
+
+int main(int argc, char **argv)
+{
+    printf("Compiler without coroutine support, skipped\n");
+    return EXIT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,913 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Pipeline.hpp"
+#include "Service.hpp"
+#include "SharedMemoryQueue.hpp"
+
+/// Elements moved through the queue per configuration.
+#define QUEUE_OPERATIONS   200000
+
+/// Round trips per configuration.
+#define ROUND_TRIPS        20000
+
+/// Top of the bounded queues.
+#define QUEUE_LIMIT        1024
+
+/// Ping pongs per wait strategy.
+#define HANDOFFS           20000
+
+/// Customers per pipeline run.
+#define PIPELINE_JOBS      20000
+
+/// Busy time of the barber per customer, in nanoseconds.
+#define HAIRCUT_NS         2000
+
+/// Jobs per submission run, split over the producers.
+#define SUBMISSIONS        128000
+
+/// Most producer threads of the submission runs.
+#define MAX_PRODUCERS      64
+
+/// Shards of the sharded submission runs.
+#define SUBMISSION_SHARDS  8
+
+/// Elements moved through a journaled queue per configuration.
+#define JOURNAL_OPERATIONS 20000
+
+/// Elements sent from one process to another per configuration.
+#define PROCESS_MESSAGES   100000
+
+/**
+ * @brief Queue element of a given size.
+ * @details Carries the time stamp of its push, so the consumer can
+ * measure the latency through the queue. The smallest payload is the
+ * time stamp alone.
+ */
+template <std::size_t Size>
+struct Payload
+{
+    std::int64_t stamp;
+    unsigned char padding[Size - sizeof(std::int64_t)];
+};
+
+template <>
+struct Payload<sizeof(std::int64_t)>
+{
+    std::int64_t stamp;
+};
+
+/**
+ * @brief Result of a single configuration.
+ */
+struct Result
+{
+    std::uint64_t operations;
+    double seconds;
+    NSA::HistogramSnapshot latency;
+};
+
+/**
+ * @brief Collects the results as a JSON array.
+ */
+class Report
+{
+public:
+    Report() : first(true)
+    {
+        printf("{\n  \"benchmarks\": [");
+    }
+
+    ~Report()
+    {
+        printf("\n  ]\n}\n");
+    }
+
+    void add(const std::string &fields, const Result &result)
+    {
+        printf("%s\n    {%s, \"operations\": %llu, \"seconds\": %.6f, \"ops_per_sec\": %.0f, "
+            "\"p50_ns\": %lld, \"p99_ns\": %lld, \"p999_ns\": %lld, \"max_ns\": %lld}",
+            first ? "" : ",", fields.c_str(),
+            static_cast<unsigned long long>(result.operations), result.seconds,
+            result.operations / result.seconds,
+            static_cast<long long>(result.latency.percentile(50.0)),
+            static_cast<long long>(result.latency.percentile(99.0)),
+            static_cast<long long>(result.latency.percentile(99.9)),
+            static_cast<long long>(result.latency.max));
+        fflush(stdout);
+        first = false;
+    }
+
+private:
+    bool first;
+};
+
+static const char *backendName(const NSA::QueueBackend backend)
+{
+    switch (backend)
+    {
+    case NSA::QueueBackend::Ring:
+        return "Ring";
+    case NSA::QueueBackend::Spsc:
+        return "Spsc";
+    default:
+        return "Locked";
+    }
+}
+
+/**
+ * @brief Moves QUEUE_OPERATIONS elements from producers to consumers.
+ */
+template <std::size_t Size>
+Result runQueue(const NSA::QueueBackend backend, const std::size_t limit,
+    const std::size_t producers, const std::size_t consumers)
+{
+    typedef Payload<Size> Element;
+
+    NSA::BlockingQueue<Element> queue(limit, backend);
+    std::vector<std::unique_ptr<NSA::LatencyHistogram>> latencies;
+    std::vector<std::thread> threads;
+    const std::size_t perProducer = QUEUE_OPERATIONS / producers;
+
+    for (std::size_t c = 0; c < consumers; c++)
+        latencies.emplace_back(new NSA::LatencyHistogram());
+
+    const std::int64_t start = NSA::metricsClock();
+
+    for (std::size_t c = 0; c < consumers; c++)
+        threads.push_back(std::thread([&queue, &latencies, c]
+        {
+            Element element;
+
+            while (queue.pop(&element))
+                latencies[c]->record(NSA::metricsClock() - element.stamp);
+        }));
+
+    std::vector<std::thread> producerThreads;
+
+    for (std::size_t p = 0; p < producers; p++)
+        producerThreads.push_back(std::thread([&queue, perProducer]
+        {
+            Element element = Element();
+
+            for (std::size_t i = 0; i < perProducer; i++)
+            {
+                element.stamp = NSA::metricsClock();
+
+                while (!queue.push(element, std::chrono::milliseconds(1000)))
+                {}
+            }
+        }));
+
+    for (std::thread &producer : producerThreads)
+        producer.join();
+
+    queue.close();
+
+    for (std::thread &consumer : threads)
+        consumer.join();
+
+    Result result;
+    result.operations = perProducer * producers;
+    result.seconds = (NSA::metricsClock() - start) / 1e9;
+
+    for (const std::unique_ptr<NSA::LatencyHistogram> &latency : latencies)
+        result.latency.merge(latency->snapshot());
+
+    return result;
+}
+
+template <std::size_t Size>
+void benchQueue(Report &report, const char *payload)
+{
+    const std::size_t shapes[][2] = {{1, 1}, {1, 4}, {4, 1}, {2, 2}, {4, 4}};
+
+    for (const std::size_t *shape : shapes)
+    {
+        const std::size_t producers = shape[0];
+        const std::size_t consumers = shape[1];
+
+        const NSA::QueueBackend backends[] = {NSA::QueueBackend::Locked, NSA::QueueBackend::Ring,
+            NSA::QueueBackend::Spsc};
+
+        for (const NSA::QueueBackend backend : backends)
+        {
+            if (backend == NSA::QueueBackend::Spsc && (producers != 1 || consumers != 1))
+                continue;
+
+            // Only the locked backend supports an unbounded queue.
+            const std::size_t limits[] = {QUEUE_LIMIT, 0};
+
+            for (const std::size_t limit : limits)
+            {
+                if (limit == 0 && backend != NSA::QueueBackend::Locked)
+                    continue;
+
+                const Result result = runQueue<Size>(backend, limit, producers, consumers);
+                char fields[256];
+
+                snprintf(fields, sizeof(fields), "\"name\": \"queue\", \"backend\": \"%s\", "
+                    "\"bounded\": %s, \"producers\": %zu, \"consumers\": %zu, \"payload\": \"%s\", "
+                    "\"payload_bytes\": %zu", backendName(backend), limit ? "true" : "false",
+                    producers, consumers, payload, sizeof(Payload<Size>));
+
+                report.add(fields, result);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Bounces a time stamp between two threads through a pair of
+ *        queues.
+ * @details Each sample is a full round trip, so two hand offs including
+ *          the wakeup of the other thread.
+ */
+template <class Wait>
+Result runHandoff(const NSA::QueueBackend backend)
+{
+    NSA::BlockingQueue<std::int64_t, Wait> forth(8, backend);
+    NSA::BlockingQueue<std::int64_t, Wait> back(8, backend);
+    NSA::LatencyHistogram latency;
+
+    std::thread echo([&forth, &back]
+    {
+        std::int64_t stamp = 0;
+
+        for (int i = 0; i < HANDOFFS; i++)
+        {
+            forth.pop(&stamp);
+            back.push(stamp);
+        }
+    });
+
+    const std::int64_t start = NSA::metricsClock();
+
+    for (int i = 0; i < HANDOFFS; i++)
+    {
+        std::int64_t stamp = 0;
+        forth.push(NSA::metricsClock());
+        back.pop(&stamp);
+        latency.record(NSA::metricsClock() - stamp);
+    }
+
+    echo.join();
+
+    Result result;
+    result.operations = HANDOFFS;
+    result.seconds = (NSA::metricsClock() - start) / 1e9;
+    result.latency = latency.snapshot();
+
+    return result;
+}
+
+template <class Wait>
+void benchHandoff(Report &report, const char *strategy)
+{
+    const NSA::QueueBackend backends[] = {NSA::QueueBackend::Locked, NSA::QueueBackend::Spsc};
+
+    for (const NSA::QueueBackend backend : backends)
+    {
+        char fields[128];
+        snprintf(fields, sizeof(fields), "\"name\": \"handoff\", \"wait\": \"%s\", \"backend\": \"%s\"",
+            strategy, backendName(backend));
+
+        report.add(fields, runHandoff<Wait>(backend));
+    }
+}
+
+/**
+ * @brief Service answering with its argument.
+ */
+class Echo : public NSA::Service
+{
+public:
+    Echo() : Service("Echo service")
+    {
+        jobTimeOut(std::chrono::milliseconds(60000));
+    }
+
+    Service::Future<int> echo(const int value)
+    {
+        NSA_MAKE_PROMISE(Echo::echoImp, int, value);
+    }
+
+private:
+    void echoImp(Service::Promise<int> promise, const int value)
+    {
+        promise->set_value(value);
+    }
+};
+
+/**
+ * @brief Calls makePromise and waits on the future, from as many
+ *        client threads as the service has workers.
+ */
+Result runRoundTrip(const std::size_t workers)
+{
+    Echo service;
+    service.detach(workers);
+
+    std::vector<std::unique_ptr<NSA::LatencyHistogram>> latencies;
+    std::vector<std::thread> clients;
+    const std::size_t perClient = ROUND_TRIPS / workers;
+
+    for (std::size_t c = 0; c < workers; c++)
+        latencies.emplace_back(new NSA::LatencyHistogram());
+
+    const std::int64_t start = NSA::metricsClock();
+
+    for (std::size_t c = 0; c < workers; c++)
+        clients.push_back(std::thread([&service, &latencies, c, perClient]
+        {
+            for (std::size_t i = 0; i < perClient; i++)
+            {
+                const std::int64_t sent = NSA::metricsClock();
+
+                if (service.echo(static_cast<int>(i))->get() != static_cast<int>(i))
+                    abort();
+
+                latencies[c]->record(NSA::metricsClock() - sent);
+            }
+        }));
+
+    for (std::thread &client : clients)
+        client.join();
+
+    Result result;
+    result.operations = perClient * workers;
+    result.seconds = (NSA::metricsClock() - start) / 1e9;
+
+    for (const std::unique_ptr<NSA::LatencyHistogram> &latency : latencies)
+        result.latency.merge(latency->snapshot());
+
+    service.join();
+
+    return result;
+}
+
+/**
+ * @brief Last hop of the pipeline, the barber of Example02.
+ * @details Busy waits for HAIRCUT_NS per customer and records the time
+ * since the customer entered the shop.
+ */
+class Barber : public NSA::Service
+{
+public:
+    Barber() : Service("Barber service", 1), served(0)
+    {
+        jobTimeOut(std::chrono::milliseconds(60000));
+    }
+
+    Service::Future<void> sitOnChair(const std::int64_t entered)
+    {
+        NSA_MAKE_PROMISE(Barber::sitOnChairImp, void, entered);
+    }
+
+    NSA::LatencyHistogram latency;
+    std::atomic<std::size_t> served;
+
+private:
+    void sitOnChairImp(Service::Promise<void> promise, const std::int64_t entered)
+    {
+        const std::int64_t started = NSA::metricsClock();
+
+        while (NSA::metricsClock() - started < HAIRCUT_NS)
+        {}
+
+        latency.record(NSA::metricsClock() - entered);
+        served++;
+        promise->set_value();
+    }
+};
+
+/**
+ * @brief Middle hop of the pipeline, the sofa of Example02.
+ */
+class Sofa : public NSA::Service
+{
+public:
+    Sofa(Barber &barber) : Service("Sofa service", 3, NSA::QueueBackend::Spsc), barber(barber)
+    {
+        jobTimeOut(std::chrono::milliseconds(60000));
+    }
+
+    Service::Future<void> sitOnSofa(const std::int64_t entered)
+    {
+        NSA_MAKE_PROMISE(Sofa::sitOnSofaImp, void, entered);
+    }
+
+private:
+    void sitOnSofaImp(Service::Promise<void> promise, const std::int64_t entered)
+    {
+        barber.sitOnChair(entered);
+        promise->set_value();
+    }
+
+    Barber &barber;
+};
+
+/**
+ * @brief First hop of the pipeline, the standing room of Example02.
+ */
+class Standing : public NSA::Service
+{
+public:
+    Standing(Sofa &sofa) : Service("Standing service", 12, NSA::QueueBackend::Spsc), sofa(sofa)
+    {
+        jobTimeOut(std::chrono::milliseconds(60000));
+    }
+
+    Service::Future<void> enterShop(const std::int64_t entered)
+    {
+        NSA_MAKE_PROMISE(Standing::enterShopImp, void, entered);
+    }
+
+private:
+    void enterShopImp(Service::Promise<void> promise, const std::int64_t entered)
+    {
+        sofa.sitOnSofa(entered);
+        promise->set_value();
+    }
+
+    Sofa &sofa;
+};
+
+/**
+ * @brief Pushes PIPELINE_JOBS customers through the barber shop.
+ * @details The topology of Example02: standing room, sofa and three
+ * barbers, each hop bounded. The samples are the times from entering
+ * the shop to the end of the haircut.
+ * @param linked Link the hops, so they exchange credits.
+ */
+Result runPipeline(const bool linked)
+{
+    Barber barber;
+    Sofa sofa(barber);
+    Standing standing(sofa);
+
+    if (linked)
+    {
+        standing.link(sofa);
+        sofa.link(barber);
+    }
+
+    barber.detach(3);
+    sofa.detach();
+    standing.detach();
+
+    const std::int64_t start = NSA::metricsClock();
+
+    for (int i = 0; i < PIPELINE_JOBS; i++)
+        standing.enterShop(NSA::metricsClock());
+
+    while (barber.served != PIPELINE_JOBS)
+        std::this_thread::yield();
+
+    Result result;
+    result.operations = PIPELINE_JOBS;
+    result.seconds = (NSA::metricsClock() - start) / 1e9;
+    result.latency = barber.latency.snapshot();
+
+    standing.join();
+    sofa.join();
+    barber.join();
+
+    return result;
+}
+
+/**
+ * @brief Round trips through a typed pipeline of three trivial stages.
+ * @details Each element passes the pipeline alone, so with fusion the
+ * second and third stage always find their service idle and run on
+ * the worker of the first one.
+ * @param fusion How the second and third stage may run.
+ */
+Result runTypedPipeline(const NSA::Fusion fusion)
+{
+    NSA::Service first("First stage"), second("Second stage"), third("Third stage");
+    first.detach();
+    second.detach();
+    third.detach();
+
+    auto line = NSA::Pipeline<std::int64_t>()
+        .stage(first, [](std::int64_t value){return value + 1;})
+        .stage(second, [](std::int64_t value){return value + 1;}, 0, fusion)
+        .stage(third, [](std::int64_t value){return value + 1;}, 0, fusion);
+
+    NSA::LatencyHistogram latency;
+    const std::int64_t start = NSA::metricsClock();
+
+    for (int i = 0; i < ROUND_TRIPS; i++)
+    {
+        const std::int64_t sent = NSA::metricsClock();
+
+        if (line.push(i).get() != i + 3)
+            abort();
+
+        latency.record(NSA::metricsClock() - sent);
+    }
+
+    Result result;
+    result.operations = ROUND_TRIPS;
+    result.seconds = (NSA::metricsClock() - start) / 1e9;
+    result.latency = latency.snapshot();
+
+    first.join();
+    second.join();
+    third.join();
+
+    return result;
+}
+
+/**
+ * @brief Service counting trivial jobs, for the submission runs.
+ */
+class Counter : public NSA::Service
+{
+public:
+    explicit Counter(const std::size_t shards) : Service("Counter service", QUEUE_LIMIT), counted(0)
+    {
+        jobShards(shards);
+        jobTimeOut(std::chrono::milliseconds(60000));
+    }
+
+    Service::Future<void> count()
+    {
+        NSA_MAKE_PROMISE(Counter::countImp, void);
+    }
+
+    std::atomic<std::size_t> counted;
+
+private:
+    void countImp(Service::Promise<void> promise)
+    {
+        counted.fetch_add(1, std::memory_order_relaxed);
+        promise->set_value();
+    }
+};
+
+/**
+ * @brief Submits SUBMISSIONS jobs from many producers to one service.
+ * @details The samples are the times of the makePromise calls alone,
+ * so they show how long producers wait on each other and on the
+ * bounded job list. The run ends once every job completed.
+ * @param producers The amount of producer threads.
+ * @param shards The shards of the job list.
+ */
+Result runSubmission(const std::size_t producers, const std::size_t shards)
+{
+    Counter service(shards);
+    service.detach(2);
+
+    std::vector<std::unique_ptr<NSA::LatencyHistogram>> latencies;
+    std::vector<std::thread> threads;
+    const std::size_t perProducer = SUBMISSIONS / producers;
+
+    for (std::size_t p = 0; p < producers; p++)
+        latencies.emplace_back(new NSA::LatencyHistogram());
+
+    const std::int64_t start = NSA::metricsClock();
+
+    for (std::size_t p = 0; p < producers; p++)
+        threads.push_back(std::thread([&service, &latencies, p, perProducer]
+        {
+            for (std::size_t i = 0; i < perProducer; i++)
+            {
+                const std::int64_t sent = NSA::metricsClock();
+                service.count();
+                latencies[p]->record(NSA::metricsClock() - sent);
+            }
+        }));
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    while (service.counted.load(std::memory_order_relaxed) != perProducer * producers)
+        std::this_thread::yield();
+
+    Result result;
+    result.operations = perProducer * producers;
+    result.seconds = (NSA::metricsClock() - start) / 1e9;
+
+    for (const std::unique_ptr<NSA::LatencyHistogram> &latency : latencies)
+        result.latency.merge(latency->snapshot());
+
+    service.join();
+
+    return result;
+}
+
+/**
+ * @brief makePromise round trips from a client on node zero to a
+ *        service placed on a given node.
+ * @details Placing the service on the node of the client keeps the job
+ * list and the promises in local memory, any other node makes every
+ * hand off cross the interconnect.
+ */
+Result runPlacement(const int node)
+{
+    Echo service;
+    service.detach(1, NSA::Scheduling::SharedQueue, NSA::Placement::onNode(node));
+
+    NSA::LatencyHistogram latency;
+
+    std::thread client([&service, &latency]
+    {
+        NSA::Placement::onNode(0).pin(0);
+        NSA::NodeMemoryScope memory(0);
+
+        for (int i = 0; i < ROUND_TRIPS; i++)
+        {
+            const std::int64_t sent = NSA::metricsClock();
+
+            if (service.echo(i)->get() != i)
+                abort();
+
+            latency.record(NSA::metricsClock() - sent);
+        }
+    });
+
+    const std::int64_t start = NSA::metricsClock();
+    client.join();
+
+    Result result;
+    result.operations = ROUND_TRIPS;
+    result.seconds = (NSA::metricsClock() - start) / 1e9;
+    result.latency = latency.snapshot();
+
+    service.join();
+
+    return result;
+}
+
+/**
+ * @brief Moves JOURNAL_OPERATIONS elements through a journaled queue to
+ *        a single consumer.
+ * @details The journal lives in a fresh directory below /tmp, which is
+ * removed afterwards. With the group commit, every push waits for its
+ * record to be synced.
+ */
+Result runJournal(const NSA::JournalSync sync, const std::size_t producers)
+{
+    typedef Payload<sizeof(std::int64_t)> Element;
+
+    char path[] = "/tmp/nsa-bench-XXXXXX";
+
+    if (!mkdtemp(path))
+        abort();
+
+    NSA::JournalOptions options;
+    options.sync = sync;
+
+    Result result;
+
+    {
+        NSA::BlockingQueue<Element> queue(QUEUE_LIMIT);
+
+        if (!queue.journal(path, options))
+            abort();
+
+        NSA::LatencyHistogram latency;
+        const std::size_t perProducer = JOURNAL_OPERATIONS / producers;
+        const std::int64_t start = NSA::metricsClock();
+
+        std::thread consumer([&queue, &latency]
+        {
+            Element element;
+
+            while (queue.pop(&element))
+                latency.record(NSA::metricsClock() - element.stamp);
+        });
+
+        std::vector<std::thread> threads;
+
+        for (std::size_t p = 0; p < producers; p++)
+            threads.push_back(std::thread([&queue, perProducer]
+            {
+                Element element = Element();
+
+                for (std::size_t i = 0; i < perProducer; i++)
+                {
+                    element.stamp = NSA::metricsClock();
+
+                    while (!queue.push(element, std::chrono::milliseconds(1000)))
+                    {}
+                }
+            }));
+
+        for (std::thread &producer : threads)
+            producer.join();
+
+        queue.close();
+        consumer.join();
+
+        result.operations = perProducer * producers;
+        result.seconds = (NSA::metricsClock() - start) / 1e9;
+        result.latency = latency.snapshot();
+    }
+
+    unlink((std::string(path) + "/head").c_str());
+
+    for (std::size_t i = 0; i < options.segments; i++)
+        unlink((std::string(path) + "/segment-" + std::to_string(i)).c_str());
+
+    rmdir(path);
+
+    return result;
+}
+
+/**
+ * @brief Sends PROCESS_MESSAGES elements of 64 bytes from a child process
+ *        to this one.
+ * @details Either through a SharedMemoryQueue, or through a Unix stream
+ * socket pair, which copies every element into the kernel and out again.
+ */
+Result runInterprocess(const bool sharedMemory)
+{
+    typedef Payload<64> Element;
+
+    const std::string name = "/nsa-bench-" + std::to_string(getpid());
+    NSA::SharedMemoryQueue<Element> queue;
+    int sockets[2] = {-1, -1};
+
+    if (sharedMemory ? !queue.create(name, QUEUE_LIMIT) : socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+        abort();
+
+    const std::int64_t start = NSA::metricsClock();
+    const pid_t child = fork();
+
+    if (child == 0)
+    {
+        NSA::SharedMemoryQueue<Element> sender;
+
+        if (sharedMemory && !sender.open(name))
+            _exit(EXIT_FAILURE);
+
+        Element element = Element();
+
+        for (int i = 0; i < PROCESS_MESSAGES; i++)
+        {
+            element.stamp = NSA::metricsClock();
+
+            if (sharedMemory)
+            {
+                while (!sender.push(element, std::chrono::milliseconds(1000)))
+                {}
+            }
+            else if (write(sockets[1], &element, sizeof(element)) != sizeof(element))
+                _exit(EXIT_FAILURE);
+        }
+
+        _exit(EXIT_SUCCESS);
+    }
+
+    NSA::LatencyHistogram latency;
+    Element element;
+
+    for (int i = 0; i < PROCESS_MESSAGES; i++)
+    {
+        if (sharedMemory)
+        {
+            if (!queue.pop(&element, std::chrono::milliseconds(10000)))
+                abort();
+        }
+        else if (recv(sockets[0], &element, sizeof(element), MSG_WAITALL) != sizeof(element))
+            abort();
+
+        latency.record(NSA::metricsClock() - element.stamp);
+    }
+
+    Result result;
+    result.operations = PROCESS_MESSAGES;
+    result.seconds = (NSA::metricsClock() - start) / 1e9;
+    result.latency = latency.snapshot();
+
+    waitpid(child, nullptr, 0);
+
+    if (sharedMemory)
+        NSA::SharedMemoryQueue<Element>::remove(name);
+    else
+    {
+        close(sockets[0]);
+        close(sockets[1]);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Runs every configuration and prints the results as JSON.
+ * @details The optional argument is the largest amount of workers for
+ * the round trip. It defaults to the amount of hardware threads.
+ */
+int main(int argc, char **argv)
+{
+    std::size_t maxWorkers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+
+    if (maxWorkers < 1)
+        maxWorkers = 1;
+
+    Report report;
+
+    benchQueue<sizeof(std::int64_t)>(report, "int64");
+    benchQueue<64>(report, "struct64");
+    benchQueue<256>(report, "struct256");
+
+    benchHandoff<NSA::BlockingWait>(report, "BlockingWait");
+    benchHandoff<NSA::SpinFutexWait>(report, "SpinFutexWait");
+
+    // Spinning only pays off if both threads have a core of their own.
+    if (std::thread::hardware_concurrency() > 1)
+        benchHandoff<NSA::SpinWait>(report, "SpinWait");
+
+    // Powers of two, plus the largest size even if it is none.
+    for (std::size_t workers = 1; ; workers = workers * 2 < maxWorkers ? workers * 2 : maxWorkers)
+    {
+        char fields[128];
+        snprintf(fields, sizeof(fields), "\"name\": \"round_trip\", \"workers\": %zu, \"clients\": %zu",
+            workers, workers);
+
+        report.add(fields, runRoundTrip(workers));
+
+        if (workers == maxWorkers)
+            break;
+    }
+
+    for (const bool linked : {false, true})
+    {
+        char fields[128];
+        snprintf(fields, sizeof(fields), "\"name\": \"pipeline\", \"linked\": %s, \"haircut_ns\": %d",
+            linked ? "true" : "false", HAIRCUT_NS);
+
+        report.add(fields, runPipeline(linked));
+    }
+
+    for (const NSA::Fusion fusion : {NSA::Fusion::Queue, NSA::Fusion::Inline})
+    {
+        char fields[128];
+        snprintf(fields, sizeof(fields), "\"name\": \"typed_pipeline\", \"stages\": 3, \"fused\": %s",
+            fusion == NSA::Fusion::Inline ? "true" : "false");
+
+        report.add(fields, runTypedPipeline(fusion));
+    }
+
+    for (std::size_t producers = 1; producers <= MAX_PRODUCERS; producers *= 2)
+    {
+        for (const std::size_t shards : {std::size_t(1), std::size_t(SUBMISSION_SHARDS)})
+        {
+            char fields[128];
+            snprintf(fields, sizeof(fields), "\"name\": \"submission\", \"producers\": %zu, \"shards\": %zu",
+                producers, shards);
+
+            report.add(fields, runSubmission(producers, shards));
+        }
+    }
+
+    // Without a second node there is nothing remote to compare with.
+    const std::size_t nodes = NSA::Placement::nodes();
+
+    for (const bool local : {true, false})
+    {
+        if (!local && nodes < 2)
+            break;
+
+        const int node = local ? 0 : static_cast<int>(nodes) - 1;
+        char fields[128];
+        snprintf(fields, sizeof(fields), "\"name\": \"placement\", \"local\": %s, \"node\": %d, \"nodes\": %zu",
+            local ? "true" : "false", node, nodes);
+
+        report.add(fields, runPlacement(node));
+    }
+
+    for (const NSA::JournalSync sync : {NSA::JournalSync::None, NSA::JournalSync::Group})
+    {
+        for (const std::size_t producers : {std::size_t(1), std::size_t(4)})
+        {
+            char fields[128];
+            snprintf(fields, sizeof(fields), "\"name\": \"journal\", \"sync\": \"%s\", \"producers\": %zu",
+                sync == NSA::JournalSync::Group ? "group" : "none", producers);
+
+            report.add(fields, runJournal(sync, producers));
+        }
+    }
+
+    for (const bool sharedMemory : {false, true})
+    {
+        char fields[128];
+        snprintf(fields, sizeof(fields), "\"name\": \"interprocess\", \"transport\": \"%s\"",
+            sharedMemory ? "shared_memory" : "socket");
+
+        report.add(fields, runInterprocess(sharedMemory));
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -212,10 +212,17 @@ int main(int argc, char **argv)
 	IcecreamVendor vendor;
 	Customers customers(vendor);
 
-	// Add 3 workers to the vendor.
-	const int storeWorkers = 3;
+	// Staff the vendor with one worker, and call in up to two more
+	// whenever customers keep waiting. Idle workers leave again.
+	NSA::Elasticity staff;
+	staff.minWorkers = 1;
+	staff.maxWorkers = 3;
+	staff.queueDepth = 2;
+	staff.sustain = std::chrono::seconds(2);
+	staff.coolDown = std::chrono::seconds(10);
+
 	printf("The store is open.\n");
-	vendor.detach(storeWorkers);
+	vendor.detach(staff);
 
 	// Add 1 worker to simulate customers.
 	printf("Customor simulation is ready.\n");
@@ -228,8 +235,8 @@ int main(int argc, char **argv)
 	// Post status information as long as the simulation runs.
 	do
 	{
-		printf("Current waiting customers: %d. Total customers: %d\n",
-			vendor.currentJobs(), vendor.totalJobs());
+		printf("Current waiting customers: %zu. Total customers: %zu. Workers: %zu\n",
+			vendor.currentJobs(), vendor.totalJobs(), vendor.currentWorkers());
 
 		status = simulationEnd->wait_for(std::chrono::seconds(1));
 	}
@@ -245,8 +252,6 @@ int main(int argc, char **argv)
 	printf("Closing store\n");
 	vendor.join();
 
-	/// The total number of customers is the total amount of jobs - the worker count.
-	/// Each worker adds a final cleanup job after it is asked to join up.
-	printf("A total of %d customers where served today.\n", vendor.totalJobs() - storeWorkers);
+	printf("A total of %zu customers where served today.\n", vendor.totalJobs());
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
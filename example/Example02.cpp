@@ -124,7 +124,7 @@ private:
 class Sofa : public NSA::Service
 {
 public:
-	Sofa(Barber &barber) : Service("Sofa service", 3),
+	Sofa(Barber &barber) : Service("Sofa service", 3, NSA::QueueBackend::Spsc),
 		barber(barber)
 	{
 		jobTimeOut(std::chrono::milliseconds(3000000));
@@ -154,7 +154,7 @@ private:
 class Standing : public NSA::Service
 {
 public:
-	Standing(Sofa &sofa) : Service("Standing service", 12), sofa(sofa)
+	Standing(Sofa &sofa) : Service("Standing service", 12, NSA::QueueBackend::Spsc), sofa(sofa)
 	{
 		jobTimeOut(std::chrono::milliseconds(3000000));
 	}
@@ -214,6 +214,11 @@ int main(int argc, char **argv)
 	Standing standing(sofa);
 	Customers customers(standing);
 
+	// A full sofa or barber holds back the hop before it between two
+	// customers, instead of blocking it in the middle of one.
+	standing.link(sofa);
+	sofa.link(barber);
+
 	barber.detach(3);
 	sofa.detach();
 	standing.detach();
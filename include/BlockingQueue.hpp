@@ -3,12 +3,58 @@
 #include <mutex>
 #include <condition_variable>
 #include <limits>
-#include <queue>
 #include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#include "CircularBuffer.hpp"
+#include "Journal.hpp"
+#include "Metrics.hpp"
+#include "RingBuffer.hpp"
+#include "SpscRing.hpp"
+#include "WaitStrategy.hpp"
 
 namespace NSA
 {
 
+/// Storage backends of the BlockingQueue.
+enum class QueueBackend
+{
+    Locked, ///< A circular buffer guarded by a mutex. Works for every size.
+    Ring,   ///< A preallocated lock-free ring. Bounded queues only.
+    Spsc,   ///< A wait-free ring for one producer and one consumer thread.
+    Ordered ///< A binary heap guarded by a mutex. Pops the smallest element first.
+};
+
+/// Outcomes of BlockingQueue::forcePush.
+enum class PushResult
+{
+    Pushed,  ///< The element was queued.
+    Evicted, ///< The element was queued after the first one was popped to make room.
+    Refused  ///< Nothing changed. The queue is closed, or full and cannot evict.
+};
+
+/**
+ * @brief Check to see if elements of a type can be compared with operator<.
+ */
+template <class T, class = void>
+struct IsOrdered : std::false_type {};
+
+template <class T>
+struct IsOrdered<T, decltype(void(std::declval<const T &>() < std::declval<const T &>()))> : std::true_type {};
+
 /*!
  * @brief Blocking topped queue implementation.
  * @details This queue has blocking and topped features. Each pop and
@@ -21,16 +67,77 @@ namespace NSA
  *          or removed.
  *          The queue itself does not store any elements. It only
  *          takes pointers to existing elements.
+ *
+ *          Waiting threads park in one of two wait sets: consumers wait
+ *          for an element, producers for room. A push wakes a single
+ *          consumer and a pop a single producer. How a thread waits is
+ *          up to the Wait strategy: BlockingWait parks right away,
+ *          SpinFutexWait spins for a while before it parks on a futex
+ *          and SpinWait never parks at all.
+ *
+ *          Instead of parking a thread, a consumer can also watch the
+ *          queue from an event loop. readiness() hands out an eventfd,
+ *          which turns readable once the queue goes from empty to non
+ *          empty. The consumer drains the queue with tryPop or
+ *          tryPopBulk until it comes up short, which clears the eventfd
+ *          again. So it costs a single write per burst of pushes and a
+ *          single read per drain.
+ *
+ *          A queue can also keep its elements in a Journal on disk, so
+ *          they survive a crash or a restart, see journal().
+ *
+ * @tparam T The element type.
+ * @tparam Wait The wait strategy, see WaitStrategy.hpp.
  *          
  * @author Gert-Jan Rozing (Gert.Rozing@myestro.de)
  * @date 08.2016
  * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
  */
-template <class T>
+template <class T, class Wait = BlockingWait>
 class BlockingQueue
 {
 public:
-    BlockingQueue(const std::size_t maxItems = 0);
+    /**
+     * @brief Creates an empty queue.
+     * @details The Ring backend needs a top of at least two elements,
+     *          the Spsc backend a top of at least one. Any smaller or
+     *          unbounded queue falls back to the Locked backend.
+     *          A Spsc queue must only be pushed by one thread and
+     *          popped by one other thread.
+     *          The Ordered backend pops the smallest element by
+     *          operator< first. Equal elements keep their FIFO order.
+     *          Types without operator< fall back to the Locked backend.
+     *
+     * @param maxItems The top of the queue. Zero means unbounded.
+     * @param backend The requested storage backend.
+     */
+    BlockingQueue(const std::size_t maxItems = 0, const QueueBackend backend = QueueBackend::Locked);
+
+    ~BlockingQueue();
+
+    BlockingQueue(const BlockingQueue &) = delete;
+    BlockingQueue &operator=(const BlockingQueue &) = delete;
+
+    /**
+     * @brief Keeps the elements in a journal on disk as well.
+     * @details Opens the journal in a directory and queues the elements
+     *          left in it by an earlier run, in their order. From then
+     *          on every push appends the element to the journal, and
+     *          every pop marks it consumed. The elements are turned into
+     *          records by JournalCodec<T>.
+     *          The journal keeps the FIFO order of the queue, so it
+     *          needs the Locked backend. Any other backend falls back to
+     *          it. A push also fails while the segment ring of the
+     *          journal is full. The replayed elements may exceed the top
+     *          of the queue, further pushes wait until it drained below.
+     *          Must be called before the queue is used.
+     *
+     * @param directory An existing directory, which holds the journal.
+     * @param options The layout and durability of the journal.
+     * @return False if the journal cannot be opened, or holds a record
+     *         the codec cannot decode. The queue stays empty then.
+     */
+    bool journal(const std::string &directory, const JournalOptions &options = JournalOptions());
 
     /**
      * @brief Blocking and waiting push.
@@ -45,7 +152,52 @@ public:
      * @param timeOut A duration after which the push will time out.
      * @return True on success. False if a timeout happend.
      */
-    bool push(T src, const std::chrono::milliseconds timeOut = std::chrono::milliseconds(30));
+    bool push(const T &src, const std::chrono::milliseconds timeOut = std::chrono::milliseconds(30));
+
+    /**
+     * @brief Blocking and waiting push of a temporary.
+     * @details Same as push, but moves src into the queue instead of
+     *          copying it. On a timeout src is left untouched.
+     */
+    bool push(T &&src, const std::chrono::milliseconds timeOut = std::chrono::milliseconds(30));
+
+    /**
+     * @brief Blocking and waiting push of a new element.
+     * @details Same as push, but the element is constructed from args.
+     *
+     * @param timeOut A duration after which the push will time out.
+     * @param args The constructor arguments of the new element.
+     * @return True on success. False if a timeout happend.
+     */
+    template <class... Args>
+    bool emplace(const std::chrono::milliseconds timeOut, Args &&...args);
+
+    /**
+     * @brief Non blocking push.
+     * @details Pushes src if there is room and returns right away
+     *          otherwise.
+     *
+     * @param src A new item to push into the queue.
+     * @return True on success. False if the queue is full or closed.
+     *         src is left untouched then.
+     */
+    bool tryPush(T &&src);
+
+    /**
+     * @brief Non blocking push, which makes room if needed.
+     * @details If the queue is full, the element which was queued first
+     *          is popped into evicted and src takes its place, under a
+     *          single lock. The Ordered backend evicts by age as well,
+     *          not the element which would be popped next.
+     *          The lock-free backends cannot do both at once, so they
+     *          refuse like tryPush instead.
+     *
+     * @param src A new item to push into the queue.
+     * @param evicted Receives the popped element.
+     * @return Whether src was queued and if an element was evicted.
+     *         src is left untouched if it was refused.
+     */
+    PushResult forcePush(T &&src, T *evicted);
 
     /**
      * @brief Blocking and waiting pop.
@@ -56,10 +208,109 @@ public:
      *          stores the first element into the dst parameter.
      * 
      * @param dst A pointer to the storage of the popped element.
-     * @return True on success. False if dst is nullptr.
+     * @return True on success. False if dst is nullptr or the queue
+     *         was closed and is drained.
      */
     bool pop(T *dst);
 
+    /**
+     * @brief Blocking and waiting bulk push.
+     * @details Waits like push until there is room for at least one
+     *          element. Afterwards the queue is locked once and as many
+     *          elements as fit are moved into the queue. Waiting
+     *          consumers are notified once for the whole range.
+     *
+     * @param begin The first element to push.
+     * @param end One past the last element to push.
+     * @param timeOut A duration after which the push will time out.
+     * @return The amount of elements moved into the queue. Zero if a
+     *         timeout happend.
+     */
+    template <class InputIt>
+    std::size_t pushBulk(InputIt begin, InputIt end,
+        const std::chrono::milliseconds timeOut = std::chrono::milliseconds(30));
+
+    /**
+     * @brief Blocking and waiting bulk pop.
+     * @details Waits like pop until there is at least one element.
+     *          Afterwards the queue is locked once and up to maxCount
+     *          elements are moved into out. Waiting producers are
+     *          notified once for the whole range.
+     *
+     * @param out An output iterator receiving the popped elements.
+     * @param maxCount The maximum amount of elements to pop.
+     * @return The amount of popped elements. Zero if maxCount is zero
+     *         or the queue was closed and is drained.
+     */
+    template <class OutputIt>
+    std::size_t popBulk(OutputIt out, const std::size_t maxCount);
+
+    /**
+     * @brief Non blocking pop.
+     * @details Pops the first element if there is one and returns
+     *          right away otherwise. Finding the queue empty clears the
+     *          readiness eventfd.
+     *
+     * @param dst A pointer to the storage of the popped element.
+     * @return True on success. False if dst is nullptr or the queue
+     *         is empty.
+     */
+    bool tryPop(T *dst);
+
+    /**
+     * @brief Non blocking bulk pop.
+     * @details Same as popBulk, but returns right away if the queue
+     *          is empty. Popping less than maxCount elements clears the
+     *          readiness eventfd.
+     *
+     * @param out An output iterator receiving the popped elements.
+     * @param maxCount The maximum amount of elements to pop.
+     * @return The amount of popped elements.
+     */
+    template <class OutputIt>
+    std::size_t tryPopBulk(OutputIt out, const std::size_t maxCount);
+
+    /**
+     * @brief Closes the queue for further input.
+     * @details Every following push is rejected. Pending elements can
+     *          still be popped. Once the queue is empty, every blocked
+     *          and every following pop returns false.
+     */
+    void close();
+
+    /**
+     * @brief Check to see if the queue was closed.
+     */
+    bool isClosed() const;
+
+    /**
+     * @brief Getter for the readiness file descriptor.
+     * @details Creates a non blocking eventfd on the first call. It is
+     *          readable while the queue holds elements nobody drained
+     *          yet, and once the queue is closed, so it fits into poll,
+     *          select or epoll. Consumers of an event loop must only use
+     *          tryPop and tryPopBulk, and pop until they come up short.
+     *          The queue owns the descriptor and closes it on
+     *          destruction.
+     *
+     * @return The file descriptor. -1 if there are no eventfds on this
+     *         system.
+     */
+    int readiness();
+
+    /**
+     * @brief Registers a foreign wait set, which gets notified like the
+     *        consumers on every push and on close.
+     * @details Used by Select to wait on several queues at once. The
+     *          wait set has to be removed by unwatch before it dies.
+     */
+    void watch(Wait *waiters);
+
+    /**
+     * @brief Removes a wait set registered by watch.
+     */
+    void unwatch(Wait *waiters);
+
     /**
      * @brief Blocking getter for the current size of the queue.
      * @details Quickly blocks the queue to check the size.
@@ -80,74 +331,781 @@ public:
      */
     const std::size_t max() const;
 
+    /**
+     * @brief Getter for the backend in use.
+     * @return The backend which stores the elements.
+     */
+    const QueueBackend backend() const;
+
+    /**
+     * @brief Getter for the most elements queued at once.
+     * @details Zero if the instrumentation is compiled out.
+     */
+    std::size_t highWater() const;
+
+    /**
+     * @brief Getter for the amount of contended locks.
+     * @details Counts how often a thread found the queue mutex taken and
+     *          had to block for it. Zero if the instrumentation is
+     *          compiled out.
+     */
+    std::size_t contentions() const;
+
+    /**
+     * @brief Getter for the time spent blocking on the queue mutex.
+     * @details The sum over all contended locks. Zero if the
+     *          instrumentation is compiled out.
+     */
+    std::chrono::nanoseconds lockWait() const;
+
 private:
-    std::queue<T> queue; 
+    bool tryPushOne(T &src);
+    bool tryPopOne(T *dst);
+    template <class InputIt> std::size_t tryPushSome(InputIt &begin, InputIt end);
+    template <class OutputIt> std::size_t tryPopSome(OutputIt &out, const std::size_t maxCount);
+    bool lockFree() const;
+    std::unique_lock<std::mutex> lockQueue() const;
+    void noteSize(const std::size_t size);
+    std::size_t lockedSize() const;
+    void insert(T &&src);
+    void extract(T &dst);
+    void evict(T &dst);
+    bool record(const T &src, std::uint64_t &last);
+    void commit(const std::uint64_t last);
+    void signal();
+    void raise();
+    void rearm();
+
+    /// Element of the Ordered backend, with its position in the FIFO order.
+    struct Ranked
+    {
+        T item;
+        std::uint64_t sequence;
+    };
+
+    /// Heap order of the Ordered backend. The top is popped first.
+    static bool later(const Ranked &a, const Ranked &b);
+
+    /// Journal of the elements, with the codec of T.
+    struct Durable
+    {
+        Journal journal;
+        void (*encode)(const T &, std::string &);
+        std::string buffer;                     ///< Last encoded element, reused under the queue lock.
+    };
+
+    CircularBuffer<T> queue;
     const std::size_t maxItems;
-    mutable std::mutex queueMutex;
-    mutable std::mutex waitMutex;
-    mutable std::condition_variable waitCondition;
+    mutable std::mutex queueMutex;              ///< Guards the Locked backend.
+
+    std::atomic<bool> closed;                   ///< Set once the queue is closed.
+
+    std::unique_ptr<RingBuffer<T>> ring;        ///< Only set for the Ring backend.
+    std::unique_ptr<SpscRing<T>> spsc;          ///< Only set for the Spsc backend.
+    std::unique_ptr<std::vector<Ranked>> heap;  ///< Only set for the Ordered backend.
+    std::uint64_t sequence;                     ///< Pushes into the heap so far.
+    std::unique_ptr<Durable> durable;           ///< Only set for a journaled queue.
+    Wait notEmpty;                              ///< Consumers waiting for an element.
+    Wait notFull;                               ///< Producers waiting for room.
+    std::atomic<int> readyFd;                   ///< Readiness eventfd, -1 until asked for.
+    std::atomic<bool> signalled;                ///< Set while readyFd holds an undrained write.
+    std::vector<Wait *> watchers;               ///< Wait sets of a Select.
+    std::atomic<std::size_t> watching;          ///< Size of watchers.
+    std::mutex watchMutex;                      ///< Guards watchers.
+
+#if NSA_METRICS_ENABLED
+    std::atomic<std::size_t> peakItems;         ///< Most elements queued at once.
+    mutable std::atomic<std::size_t> contended; ///< Locks of the queue mutex which blocked.
+    mutable std::atomic<std::uint64_t> blocked; ///< Nanoseconds the contended locks blocked.
+#endif
 };
 
 /// Implementation.
 
-template <class T>
-BlockingQueue<T>::BlockingQueue(const std::size_t maxItems) :
-    maxItems(maxItems <= 0 ? std::numeric_limits<std::size_t>::max() : maxItems)
-{}
+template <class T, class Wait>
+BlockingQueue<T, Wait>::BlockingQueue(const std::size_t maxItems, const QueueBackend backend) :
+    queue(maxItems > 0 && maxItems < 16 ? maxItems : 16),
+    maxItems(maxItems <= 0 ? std::numeric_limits<std::size_t>::max() : maxItems),
+    closed(false),
+    sequence(0),
+    readyFd(-1),
+    signalled(false),
+    watching(0)
+#if NSA_METRICS_ENABLED
+    , peakItems(0),
+    contended(0),
+    blocked(0)
+#endif
+{
+    if (backend == QueueBackend::Ring && maxItems >= 2)
+        ring.reset(new RingBuffer<T>(maxItems));
+    else if (backend == QueueBackend::Spsc && maxItems >= 1)
+        spsc.reset(new SpscRing<T>(maxItems));
+    else if (backend == QueueBackend::Ordered && IsOrdered<T>::value)
+        heap.reset(new std::vector<Ranked>());
+}
 
-template <class T>
-bool BlockingQueue<T>::push(T src, const std::chrono::milliseconds timeOut)
+template <class T, class Wait>
+BlockingQueue<T, Wait>::~BlockingQueue()
+{
+#if defined(__linux__)
+    if (readyFd >= 0)
+        ::close(readyFd);
+#endif
+}
+
+template <class T, class Wait>
+bool BlockingQueue<T, Wait>::journal(const std::string &directory, const JournalOptions &options)
+{
+    std::unique_ptr<Durable> opened(new Durable());
+    opened->encode = &JournalCodec<T>::encode;
+
+    // The backend only changes once the journal is open.
+    CircularBuffer<T> replayed;
+
+    const bool open = opened->journal.open(directory, options,
+        [&replayed](const char *data, const std::size_t size)
+        {
+            T item;
+
+            if (!JournalCodec<T>::decode(data, size, item))
+                return false;
+
+            replayed.push(std::move(item));
+            return true;
+        });
+
+    if (!open)
+        return false;
+
+    ring.reset();
+    spsc.reset();
+    heap.reset();
+
+    {
+        std::unique_lock<std::mutex> lock = lockQueue();
+
+        for (; !replayed.empty(); replayed.pop())
+            insert(std::move(replayed.front()));
+
+        noteSize(lockedSize());
+        durable = std::move(opened);
+    }
+
+    signal();
+    return true;
+}
+
+template <class T, class Wait>
+bool BlockingQueue<T, Wait>::push(const T &src, const std::chrono::milliseconds timeOut)
+{
+    T copy(src);
+    return push(std::move(copy), timeOut);
+}
+
+template <class T, class Wait>
+template <class... Args>
+bool BlockingQueue<T, Wait>::emplace(const std::chrono::milliseconds timeOut, Args &&...args)
+{
+    return push(T(std::forward<Args>(args)...), timeOut);
+}
+
+template <class T, class Wait>
+bool BlockingQueue<T, Wait>::push(T &&src, const std::chrono::milliseconds timeOut)
+{
+    if (closed)
+        return false;
+
+    if (!tryPushOne(src))
+    {
+        bool pushed = false;
+
+        notFull.waitUntil([this, &src, &pushed]{return (pushed = tryPushOne(src)) || closed;},
+            std::chrono::steady_clock::now() + timeOut);
+
+        if (!pushed)
+            return false;
+    }
+
+    notEmpty.notifyOne();
+    signal();
+    return true;
+}
+
+template <class T, class Wait>
+bool BlockingQueue<T, Wait>::tryPush(T &&src)
+{
+    if (closed || !tryPushOne(src))
+        return false;
+
+    notEmpty.notifyOne();
+    signal();
+    return true;
+}
+
+template <class T, class Wait>
+PushResult BlockingQueue<T, Wait>::forcePush(T &&src, T *evicted)
+{
+    if (lockFree())
+        return tryPush(std::move(src)) ? PushResult::Pushed : PushResult::Refused;
+
+    PushResult result = PushResult::Pushed;
+    std::uint64_t last = 0;
+
+    {
+        std::unique_lock<std::mutex> lock = lockQueue();
+
+        if (closed || !record(src, last))
+            return PushResult::Refused;
+
+        if (lockedSize() >= maxItems)
+        {
+            evict(*evicted);
+            result = PushResult::Evicted;
+        }
+
+        insert(std::move(src));
+        noteSize(lockedSize());
+    }
+
+    commit(last);
+    notEmpty.notifyOne();
+    signal();
+    return result;
+}
+
+template <class T, class Wait>
+bool BlockingQueue<T, Wait>::pop(T *dst)
+{
+    if (dst == nullptr)
+        return false;
+
+    if (!tryPopOne(dst))
+    {
+        bool popped = false;
+
+        notEmpty.wait([this, dst, &popped]{return (popped = tryPopOne(dst)) || closed;});
+
+        // Closing races with the last producers, so look once more.
+        if (!popped && !tryPopOne(dst))
+            return false;
+    }
+
+    notFull.notifyOne();
+    return true;
+}
+
+template <class T, class Wait>
+template <class InputIt>
+std::size_t BlockingQueue<T, Wait>::pushBulk(InputIt begin, InputIt end, const std::chrono::milliseconds timeOut)
+{
+    if (begin == end || closed)
+        return 0;
+
+    std::size_t count = tryPushSome(begin, end);
+
+    if (count == 0)
+        notFull.waitUntil([this, &begin, end, &count]{return (count = tryPushSome(begin, end)) > 0 || closed;},
+            std::chrono::steady_clock::now() + timeOut);
+
+    if (count == 1)
+        notEmpty.notifyOne();
+    else if (count > 1)
+        notEmpty.notifyAll();
+
+    if (count > 0)
+        signal();
+
+    return count;
+}
+
+template <class T, class Wait>
+template <class OutputIt>
+std::size_t BlockingQueue<T, Wait>::popBulk(OutputIt out, const std::size_t maxCount)
+{
+    if (maxCount == 0)
+        return 0;
+
+    std::size_t count = tryPopSome(out, maxCount);
+
+    if (count == 0)
+    {
+        notEmpty.wait([this, &out, maxCount, &count]{return (count = tryPopSome(out, maxCount)) > 0 || closed;});
+
+        if (count == 0)
+            count = tryPopSome(out, maxCount);
+    }
+
+    if (count == 1)
+        notFull.notifyOne();
+    else if (count > 1)
+        notFull.notifyAll();
+
+    return count;
+}
+
+template <class T, class Wait>
+bool BlockingQueue<T, Wait>::tryPop(T *dst)
+{
+    if (dst == nullptr)
+        return false;
+
+    if (!tryPopOne(dst))
+    {
+        rearm();
+        return false;
+    }
+
+    notFull.notifyOne();
+    return true;
+}
+
+template <class T, class Wait>
+template <class OutputIt>
+std::size_t BlockingQueue<T, Wait>::tryPopBulk(OutputIt out, const std::size_t maxCount)
+{
+    const std::size_t count = tryPopSome(out, maxCount);
+
+    if (count == 1)
+        notFull.notifyOne();
+    else if (count > 1)
+        notFull.notifyAll();
+
+    if (count < maxCount)
+        rearm();
+
+    return count;
+}
+
+template <class T, class Wait>
+void BlockingQueue<T, Wait>::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        closed = true;
+    }
+
+    notEmpty.notifyAll();
+    notFull.notifyAll();
+    signal();
+}
+
+template <class T, class Wait>
+inline bool BlockingQueue<T, Wait>::isClosed() const
 {
-    std::unique_lock<std::mutex> waitLock(waitMutex);
+    return closed;
+}
 
-    if (waitCondition.wait_for(waitLock, timeOut, [this]{return queue.size() < maxItems;}))
+template <class T, class Wait>
+int BlockingQueue<T, Wait>::readiness()
+{
+#if defined(__linux__)
     {
         std::lock_guard<std::mutex> lock(queueMutex);
-        queue.push(src);
-        waitCondition.notify_all();
 
+        if (readyFd < 0)
+            readyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+
+    // Elements pushed before the eventfd existed did not signal it.
+    if (!empty() || closed)
+        signal();
+
+    return readyFd;
+#else
+    return -1;
+#endif
+}
+
+template <class T, class Wait>
+void BlockingQueue<T, Wait>::watch(Wait *waiters)
+{
+    std::lock_guard<std::mutex> lock(watchMutex);
+    watchers.push_back(waiters);
+    watching = watchers.size();
+}
+
+template <class T, class Wait>
+void BlockingQueue<T, Wait>::unwatch(Wait *waiters)
+{
+    std::lock_guard<std::mutex> lock(watchMutex);
+    watchers.erase(std::remove(watchers.begin(), watchers.end(), waiters), watchers.end());
+    watching = watchers.size();
+}
+
+template <class T, class Wait>
+void BlockingQueue<T, Wait>::signal()
+{
+    // The notify of notEmpty right before fences the change of the queue
+    // against this load, the same way it does for its own waiters.
+    if (watching.load(std::memory_order_relaxed) != 0)
+    {
+        std::lock_guard<std::mutex> lock(watchMutex);
+
+        for (Wait *waiters : watchers)
+            waiters->notifyOne();
+    }
+
+    raise();
+}
+
+template <class T, class Wait>
+void BlockingQueue<T, Wait>::raise()
+{
+#if defined(__linux__)
+    const int fd = readyFd.load(std::memory_order_acquire);
+
+    // Only the first push after a drain writes, the others find the flag set.
+    if (fd >= 0 && !signalled.exchange(true))
+    {
+        const std::uint64_t one = 1;
+        ssize_t written = write(fd, &one, sizeof(one));
+        (void)written;
+    }
+#endif
+}
+
+template <class T, class Wait>
+void BlockingQueue<T, Wait>::rearm()
+{
+#if defined(__linux__)
+    const int fd = readyFd.load(std::memory_order_acquire);
+
+    if (fd < 0 || !signalled.load(std::memory_order_relaxed))
+        return;
+
+    // Clear the eventfd before the flag. A push in between writes again,
+    // a push before finds the flag set, but is seen by the check below.
+    std::uint64_t value = 0;
+    ssize_t got = read(fd, &value, sizeof(value));
+    (void)got;
+
+    signalled.exchange(false);
+
+    // Only the eventfd level is refreshed. The watchers were notified by
+    // the push or close itself, and a Select pops from under the lock of
+    // its wait set, so notifying it from here would deadlock.
+    if (!empty() || closed)
+        raise();
+#endif
+}
+
+template <class T, class Wait>
+inline bool BlockingQueue<T, Wait>::lockFree() const
+{
+    return ring || spsc;
+}
+
+template <class T, class Wait>
+bool BlockingQueue<T, Wait>::tryPushOne(T &src)
+{
+    if (lockFree())
+    {
+        if (!(ring ? ring->tryPush(std::move(src)) : spsc->tryPush(std::move(src))))
+            return false;
+
+        noteSize(size());
         return true;
-    }   
+    }
+
+    std::uint64_t last = 0;
 
-    return false;     
+    {
+        // Closing takes the lock as well, so nothing slips in afterwards.
+        std::unique_lock<std::mutex> lock = lockQueue();
+
+        if (closed || lockedSize() >= maxItems || !record(src, last))
+            return false;
+
+        insert(std::move(src));
+        noteSize(lockedSize());
+    }
+
+    commit(last);
+    return true;
 }
 
-template <class T>
-bool BlockingQueue<T>::pop(T *dst)
+template <class T, class Wait>
+bool BlockingQueue<T, Wait>::tryPopOne(T *dst)
 {
-    if (dst == nullptr)
+    if (lockFree())
+        return ring ? ring->tryPop(*dst) : spsc->tryPop(*dst);
+
+    std::unique_lock<std::mutex> lock = lockQueue();
+
+    if (lockedSize() == 0)
         return false;
 
-    std::unique_lock<std::mutex> waitLock(waitMutex);
+    extract(*dst);
+
+    return true;
+}
 
-    waitCondition.wait(waitLock, [this]{return !queue.empty();});
+template <class T, class Wait>
+template <class InputIt>
+std::size_t BlockingQueue<T, Wait>::tryPushSome(InputIt &begin, InputIt end)
+{
+    std::size_t count = 0;
 
-    std::lock_guard<std::mutex> lock(queueMutex);
-    *dst = queue.front();
-    queue.pop();
-    waitCondition.notify_all();        
+    if (lockFree())
+    {
+        for (; begin != end && tryPushOne(*begin); ++begin)
+            count++;
+
+        return count;
+    }
+
+    std::uint64_t last = 0;
+
+    {
+        std::unique_lock<std::mutex> lock = lockQueue();
+
+        if (closed)
+            return count;
 
+        for (; begin != end && lockedSize() < maxItems && record(*begin, last); ++begin, ++count)
+            insert(std::move(*begin));
+
+        noteSize(lockedSize());
+    }
+
+    // One commit covers the whole batch.
+    commit(last);
+    return count;
+}
+
+template <class T, class Wait>
+template <class OutputIt>
+std::size_t BlockingQueue<T, Wait>::tryPopSome(OutputIt &out, const std::size_t maxCount)
+{
+    std::size_t count = 0;
+
+    if (lockFree())
+    {
+        T item;
+
+        for (; count < maxCount && tryPopOne(&item); count++)
+            *out++ = std::move(item);
+
+        return count;
+    }
+
+    std::unique_lock<std::mutex> lock = lockQueue();
+
+    T item;
+
+    for (; count < maxCount && lockedSize() > 0; count++)
+    {
+        extract(item);
+        *out++ = std::move(item);
+    }
+
+    return count;
+}
+
+template <class T, class Wait>
+inline std::size_t BlockingQueue<T, Wait>::lockedSize() const
+{
+    return heap ? heap->size() : queue.size();
+}
+
+template <class T, class Wait>
+void BlockingQueue<T, Wait>::insert(T &&src)
+{
+    if (!heap)
+    {
+        queue.push(std::move(src));
+        return;
+    }
+
+    heap->push_back(Ranked{std::move(src), sequence++});
+    std::push_heap(heap->begin(), heap->end(), &BlockingQueue::later);
+}
+
+template <class T, class Wait>
+void BlockingQueue<T, Wait>::extract(T &dst)
+{
+    if (durable)
+        durable->journal.consume(1);
+
+    if (!heap)
+    {
+        dst = std::move(queue.front());
+        queue.pop();
+        return;
+    }
+
+    std::pop_heap(heap->begin(), heap->end(), &BlockingQueue::later);
+    dst = std::move(heap->back().item);
+    heap->pop_back();
+}
+
+template <class T, class Wait>
+void BlockingQueue<T, Wait>::evict(T &dst)
+{
+    if (!heap)
+    {
+        extract(dst);
+        return;
+    }
+
+    // The oldest element can sit anywhere in the heap. Overflows are
+    // rare, so a scan and a rebuild are fine.
+    typename std::vector<Ranked>::iterator oldest = std::min_element(heap->begin(), heap->end(),
+        [](const Ranked &a, const Ranked &b){return a.sequence < b.sequence;});
+
+    dst = std::move(oldest->item);
+    *oldest = std::move(heap->back());
+    heap->pop_back();
+    std::make_heap(heap->begin(), heap->end(), &BlockingQueue::later);
+}
+
+template <class T, class Wait>
+bool BlockingQueue<T, Wait>::record(const T &src, std::uint64_t &last)
+{
+    // Called under the queue lock, right before the element is inserted,
+    // so the journal keeps the order of the queue.
+    if (!durable)
+        return true;
+
+    durable->encode(src, durable->buffer);
+    const std::uint64_t appended = durable->journal.append(durable->buffer.data(), durable->buffer.size());
+
+    if (appended == 0)
+        return false;
+
+    last = appended;
     return true;
 }
 
-template <class T>
-const size_t BlockingQueue<T>::size() const
+template <class T, class Wait>
+inline void BlockingQueue<T, Wait>::commit(const std::uint64_t last)
+{
+    // Called after the queue lock is released, so the producers of a
+    // burst share a single sync.
+    if (last != 0)
+        durable->journal.commit(last);
+}
+
+template <class T, class Wait>
+bool BlockingQueue<T, Wait>::later(const Ranked &a, const Ranked &b)
+{
+    if constexpr (IsOrdered<T>::value)
+    {
+        if (b.item < a.item)
+            return true;
+
+        if (a.item < b.item)
+            return false;
+    }
+
+    return a.sequence > b.sequence;
+}
+
+template <class T, class Wait>
+std::unique_lock<std::mutex> BlockingQueue<T, Wait>::lockQueue() const
 {
+#if NSA_METRICS_ENABLED
+    std::unique_lock<std::mutex> lock(queueMutex, std::try_to_lock);
+
+    if (!lock.owns_lock())
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        lock.lock();
+
+        contended.fetch_add(1, std::memory_order_relaxed);
+        blocked.fetch_add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+    }
+
+    return lock;
+#else
+    return std::unique_lock<std::mutex>(queueMutex);
+#endif
+}
+
+template <class T, class Wait>
+inline void BlockingQueue<T, Wait>::noteSize(const std::size_t size)
+{
+#if NSA_METRICS_ENABLED
+    std::size_t peak = peakItems.load(std::memory_order_relaxed);
+
+    while (size > peak && !peakItems.compare_exchange_weak(peak, size, std::memory_order_relaxed))
+    {}
+#else
+    (void)size;
+#endif
+}
+
+template <class T, class Wait>
+std::size_t BlockingQueue<T, Wait>::highWater() const
+{
+#if NSA_METRICS_ENABLED
+    return peakItems.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+template <class T, class Wait>
+std::size_t BlockingQueue<T, Wait>::contentions() const
+{
+#if NSA_METRICS_ENABLED
+    return contended.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+template <class T, class Wait>
+std::chrono::nanoseconds BlockingQueue<T, Wait>::lockWait() const
+{
+#if NSA_METRICS_ENABLED
+    return std::chrono::nanoseconds(blocked.load(std::memory_order_relaxed));
+#else
+    return std::chrono::nanoseconds(0);
+#endif
+}
+
+template <class T, class Wait>
+const size_t BlockingQueue<T, Wait>::size() const
+{
+    if (ring)
+        return ring->size();
+
+    if (spsc)
+        return spsc->size();
+
     std::lock_guard<std::mutex> lock(queueMutex);
-    return queue.size();
+    return lockedSize();
 }
 
-template <class T>
-inline const std::size_t BlockingQueue<T>::max() const
+template <class T, class Wait>
+inline const std::size_t BlockingQueue<T, Wait>::max() const
 {
     return maxItems;
 }
 
-template <class T>
-const bool BlockingQueue<T>::empty() const
+template <class T, class Wait>
+inline const QueueBackend BlockingQueue<T, Wait>::backend() const
+{
+    if (ring)
+        return QueueBackend::Ring;
+
+    if (heap)
+        return QueueBackend::Ordered;
+
+    return spsc ? QueueBackend::Spsc : QueueBackend::Locked;
+}
+
+template <class T, class Wait>
+const bool BlockingQueue<T, Wait>::empty() const
 {
+    if (lockFree())
+        return size() == 0;
+
     std::lock_guard<std::mutex> lock(queueMutex);
-    return queue.empty();
+    return lockedSize() == 0;
 }
 
-} // namespace NSA
\ No newline at end of file
+} // namespace NSA
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace NSA
+{
+
+/*!
+ * @brief Growable circular buffer with a queue interface.
+ * @details Replaces std::queue as storage of the locked BlockingQueue.
+ *          A std::deque allocates and frees a chunk every few elements
+ *          while a queue is streaming. This buffer doubles its storage
+ *          whenever it is full and never shrinks, so once it reached
+ *          its working size, push and pop never touch the heap again.
+ *          The buffer is not thread safe. The slots are raw storage,
+ *          elements are constructed in place and destroyed on pop, so
+ *          T needs no more than it needs for std::queue.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class T>
+class CircularBuffer
+{
+public:
+    /**
+     * @param reserved The amount of slots allocated up front.
+     */
+    CircularBuffer(const std::size_t reserved = 16);
+    ~CircularBuffer();
+
+    CircularBuffer(const CircularBuffer &) = delete;
+    CircularBuffer &operator=(const CircularBuffer &) = delete;
+
+    void push(T &&src);
+    template <class... Args> void emplace(Args &&...args);
+    T &front();
+    void pop();
+    T &back();
+    void popBack();
+
+    std::size_t size() const;
+    bool empty() const;
+
+private:
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T &data()
+        {
+            return *reinterpret_cast<T *>(storage);
+        }
+    };
+
+    void grow();
+    Slot &slot(const std::size_t index);
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t slotCount;
+    std::size_t head;
+    std::size_t count;
+};
+
+/// Implementation.
+
+template <class T>
+CircularBuffer<T>::CircularBuffer(const std::size_t reserved) :
+    slots(new Slot[reserved < 1 ? 1 : reserved]),
+    slotCount(reserved < 1 ? 1 : reserved),
+    head(0),
+    count(0)
+{}
+
+template <class T>
+CircularBuffer<T>::~CircularBuffer()
+{
+    while (count > 0)
+        pop();
+}
+
+template <class T>
+void CircularBuffer<T>::push(T &&src)
+{
+    emplace(std::move(src));
+}
+
+template <class T>
+template <class... Args>
+void CircularBuffer<T>::emplace(Args &&...args)
+{
+    if (count == slotCount)
+        grow();
+
+    new (slot(count).storage) T(std::forward<Args>(args)...);
+    count++;
+}
+
+template <class T>
+inline T &CircularBuffer<T>::front()
+{
+    return slot(0).data();
+}
+
+template <class T>
+void CircularBuffer<T>::pop()
+{
+    front().~T();
+    head = (head + 1) % slotCount;
+    count--;
+}
+
+template <class T>
+inline T &CircularBuffer<T>::back()
+{
+    return slot(count - 1).data();
+}
+
+template <class T>
+void CircularBuffer<T>::popBack()
+{
+    back().~T();
+    count--;
+}
+
+template <class T>
+inline std::size_t CircularBuffer<T>::size() const
+{
+    return count;
+}
+
+template <class T>
+inline bool CircularBuffer<T>::empty() const
+{
+    return count == 0;
+}
+
+template <class T>
+inline typename CircularBuffer<T>::Slot &CircularBuffer<T>::slot(const std::size_t index)
+{
+    return slots[(head + index) % slotCount];
+}
+
+template <class T>
+void CircularBuffer<T>::grow()
+{
+    std::unique_ptr<Slot[]> larger(new Slot[slotCount * 2]);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        T &item = slot(i).data();
+        new (larger[i].storage) T(std::move(item));
+        item.~T();
+    }
+
+    slots.swap(larger);
+    slotCount *= 2;
+    head = 0;
+}
+
+} // namespace NSA
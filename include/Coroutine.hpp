@@ -0,0 +1,256 @@
+#pragma once
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <coroutine>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+#include "Future.hpp"
+#include "Service.hpp"
+
+namespace NSA
+{
+
+/**
+ * @brief Job which continues a suspended coroutine.
+ * @details A job dropped from the job list continues the coroutine
+ * as well, on the thread which drops it. The awaited future is ready
+ * by then, so the coroutine always completes its own future.
+ */
+struct Resumption
+{
+	std::coroutine_handle<> handle;
+
+	void operator()()
+	{
+		handle.resume();
+	}
+
+	void cancel(std::exception_ptr)
+	{
+		handle.resume();
+	}
+};
+
+/**
+ * @brief Continues a suspended coroutine on the workers of a service.
+ * @details If there is no service, if the calling thread already is a
+ * worker of the service, or if the service does not take the job, the
+ * coroutine is resumed right away on the calling thread. The calling
+ * thread completes a future, so it never waits for room in the job
+ * list, like a continuation of Future::then.
+ */
+inline void resumeOn(Service *service, std::coroutine_handle<> handle)
+{
+	if (service == nullptr || service->onWorkerThread())
+		handle.resume();
+	else
+		service->tryPost(Resumption{handle});
+}
+
+/**
+ * @brief Awaiter suspending a coroutine until a future is ready.
+ * @details The coroutine does not block any thread while it waits. It
+ * is resumed on the workers of the owning service, if there is one.
+ */
+template <class T>
+class FutureAwaiter
+{
+public:
+	FutureAwaiter(Future<T> future, Service *owner) : future(std::move(future)), owner(owner) {}
+
+	bool await_ready() const
+	{
+		return future.ready();
+	}
+
+	bool await_suspend(std::coroutine_handle<> handle)
+	{
+		Service *service = owner;
+
+		// The continuation may run on another thread before this call
+		// returns, so the awaiter must not be touched afterwards.
+		return future.setContinuation([service, handle]{resumeOn(service, handle);});
+	}
+
+	T await_resume()
+	{
+		return future.get();
+	}
+
+private:
+	Future<T> future;
+	Service *owner;
+};
+
+/// Makes every future awaitable. Outside of a service coroutine, the
+/// awaiting coroutine resumes on the thread which sets the result.
+template <class T>
+FutureAwaiter<T> operator co_await(Future<T> future)
+{
+	return FutureAwaiter<T>(std::move(future), nullptr);
+}
+
+template <class T> struct IsFuture : std::false_type {};
+template <class T> struct IsFuture<Future<T>> : std::true_type {};
+
+/**
+ * @brief Coroutine promise behind a coroutine returning a Future.
+ * @details A member function of a service which returns a
+ * Service::Future<T> may be a coroutine. Calling it queues the body
+ * on the job list of the service, just like NSA_MAKE_PROMISE does.
+ * Whenever the body awaits a future, it gives its worker back, and
+ * continues on a worker of the same service once the result is there.
+ *
+ * The owning service is taken from the first argument of the coroutine,
+ * which is the object itself for member functions. Coroutines without
+ * a service start right away and resume on whatever thread completes
+ * the awaited future.
+ */
+template <class T>
+class CoroutinePromiseBase
+{
+public:
+	template <class First, class... Args>
+	CoroutinePromiseBase(First &first, Args &...) : owner(serviceOf(first)) {}
+
+	CoroutinePromiseBase() : owner(nullptr) {}
+
+	Future<T> get_return_object()
+	{
+		return promise.get_future();
+	}
+
+	/// Queues the body of the coroutine on the owning service.
+	struct Schedule
+	{
+		Service *owner;
+		std::exception_ptr refused;
+
+		/// The queued body. A body dropped from the job list resumes
+		/// with the error, so the coroutine completes its future.
+		struct Resume
+		{
+			Schedule *schedule;
+			std::coroutine_handle<> handle;
+
+			void operator()()
+			{
+				handle.resume();
+			}
+
+			void cancel(std::exception_ptr error)
+			{
+				schedule->refused = error;
+				handle.resume();
+			}
+		};
+
+		bool await_ready() const
+		{
+			return owner == nullptr;
+		}
+
+		bool await_suspend(std::coroutine_handle<> handle)
+		{
+			Service *service = owner;
+
+			// The body may run on another thread before this call
+			// returns, so the awaiter must not be touched afterwards.
+			if (service->post(Resume{this, handle}))
+				return true;
+
+			// Like a job which cannot be queued, the coroutine fails
+			// with an Overloaded error.
+			refused = std::make_exception_ptr(Overloaded(service->serviceName()));
+			return false;
+		}
+
+		void await_resume() const
+		{
+			if (refused)
+				std::rethrow_exception(refused);
+		}
+	};
+
+	Schedule initial_suspend()
+	{
+		return Schedule{owner, nullptr};
+	}
+
+	std::suspend_never final_suspend() noexcept
+	{
+		return std::suspend_never();
+	}
+
+	void unhandled_exception()
+	{
+		promise.set_exception(std::current_exception());
+	}
+
+	template <class U>
+	FutureAwaiter<U> await_transform(Future<U> future)
+	{
+		return FutureAwaiter<U>(std::move(future), owner);
+	}
+
+	template <class Awaitable, class = typename std::enable_if<
+		!IsFuture<typename std::decay<Awaitable>::type>::value>::type>
+	Awaitable &&await_transform(Awaitable &&awaitable)
+	{
+		return std::forward<Awaitable>(awaitable);
+	}
+
+protected:
+	Promise<T> promise;
+
+private:
+	template <class First>
+	static Service *serviceOf(First &first)
+	{
+		if constexpr (std::is_base_of<Service, First>::value)
+			return &first;
+		else
+			return nullptr;
+	}
+
+	Service *owner;
+};
+
+template <class T>
+class CoroutinePromise : public CoroutinePromiseBase<T>
+{
+public:
+	using CoroutinePromiseBase<T>::CoroutinePromiseBase;
+
+	template <class U>
+	void return_value(U &&value)
+	{
+		this->promise.set_value(std::forward<U>(value));
+	}
+};
+
+template <>
+class CoroutinePromise<void> : public CoroutinePromiseBase<void>
+{
+public:
+	using CoroutinePromiseBase<void>::CoroutinePromiseBase;
+
+	void return_void()
+	{
+		this->promise.set_value();
+	}
+};
+
+} // namespace NSA
+
+/// Lets every function returning a NSA::Future be a coroutine.
+template <class T, class... Args>
+struct std::coroutine_traits<NSA::Future<T>, Args...>
+{
+	using promise_type = NSA::CoroutinePromise<T>;
+};
+
+#endif
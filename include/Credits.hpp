@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+#include "WaitStrategy.hpp"
+
+namespace NSA
+{
+
+/*!
+ * @brief Counting semaphore for the free room of a bounded queue.
+ * @details A producer takes a credit before it commits to push an
+ *          element and the consumer hands the credit back once it
+ *          popped that element. As long as every producer plays by
+ *          these rules, a push never finds the queue full, so the
+ *          producers wait for room at a point of their choosing
+ *          instead of inside the push.
+ *          Taking and returning credits is a single atomic operation.
+ *          Only a producer which runs out of credits parks in the
+ *          wait set.
+ *
+ * @tparam Wait The wait strategy, see WaitStrategy.hpp.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class Wait = BlockingWait>
+class Credits
+{
+public:
+    /**
+     * @param capacity The amount of credits, usually the top of the queue.
+     */
+    explicit Credits(const std::size_t capacity) : credits(capacity), capacity(capacity) {}
+
+    Credits(const Credits &) = delete;
+    Credits &operator=(const Credits &) = delete;
+
+    /**
+     * @brief Non blocking take of up to maxCount credits.
+     * @return The amount of credits taken.
+     */
+    std::size_t tryAcquire(const std::size_t maxCount)
+    {
+        std::size_t available = credits.load(std::memory_order_relaxed);
+        std::size_t count = 0;
+
+        do
+        {
+            count = std::min(available, maxCount);
+
+            if (count == 0)
+                return 0;
+        }
+        while (!credits.compare_exchange_weak(available, available - count, std::memory_order_acquire,
+            std::memory_order_relaxed));
+
+        return count;
+    }
+
+    /**
+     * @brief Blocking take of up to maxCount credits.
+     * @details Waits until at least one credit is available, or until
+     *          stop holds.
+     * @param maxCount The maximum amount of credits to take.
+     * @param stop Predicate which ends the wait without a credit.
+     * @return The amount of credits taken. Zero if stop ended the wait.
+     */
+    template <class Predicate>
+    std::size_t acquire(const std::size_t maxCount, Predicate stop)
+    {
+        std::size_t count = tryAcquire(maxCount);
+
+        if (count == 0)
+            waiters.wait([this, maxCount, &stop, &count]{return (count = tryAcquire(maxCount)) > 0 || stop();});
+
+        return count;
+    }
+
+    /**
+     * @brief Blocking take of up to maxCount credits, which gives up at
+     *        a deadline.
+     * @return The amount of credits taken. Zero if stop ended the wait
+     *         or the deadline passed.
+     */
+    template <class Predicate>
+    std::size_t acquire(const std::size_t maxCount, Predicate stop,
+        const std::chrono::steady_clock::time_point deadline)
+    {
+        std::size_t count = tryAcquire(maxCount);
+
+        if (count == 0)
+            waiters.waitUntil([this, maxCount, &stop, &count]{return (count = tryAcquire(maxCount)) > 0 || stop();},
+                deadline);
+
+        return count;
+    }
+
+    /**
+     * @brief Hands credits back and wakes the waiting producers.
+     */
+    void release(const std::size_t count)
+    {
+        if (count == 0)
+            return;
+
+        credits.fetch_add(count, std::memory_order_release);
+
+        if (count == 1)
+            waiters.notifyOne();
+        else
+            waiters.notifyAll();
+    }
+
+    /**
+     * @brief Wakes every waiting producer, so it checks its stop
+     *        predicate again.
+     */
+    void wake()
+    {
+        waiters.notifyAll();
+    }
+
+    /**
+     * @brief Getter for the amount of credits not taken.
+     */
+    std::size_t available() const
+    {
+        return credits.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Getter for the amount of credits in total.
+     */
+    std::size_t total() const
+    {
+        return capacity;
+    }
+
+private:
+    std::atomic<std::size_t> credits;   ///< Credits not taken.
+    const std::size_t capacity;         ///< Credits in total.
+    Wait waiters;                       ///< Producers out of credits.
+};
+
+} // namespace NSA
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BlockingQueue.hpp"
+#include "Job.hpp"
+
+namespace NSA
+{
+
+/*!
+ * @brief Fixed size thread pool shared by many services.
+ * @details A service which is attached to an executor does not own any
+ *          threads. Instead it posts tasks to the executor, which drain
+ *          the job list of the service on one of the pool threads. This
+ *          way a whole graph of services runs on as many threads as
+ *          the hardware offers.
+ *          The executor runs tasks in the order they were posted. A
+ *          task should not block for long, since it keeps a pool
+ *          thread from serving other services.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+class Executor
+{
+public:
+    /**
+     * @brief Starts the pool threads.
+     * @param threads The size of the pool. Zero means one thread per
+     *        hardware thread.
+     */
+    Executor(const std::size_t threads = 0)
+    {
+        std::size_t count = threads;
+
+        if (count == 0)
+            count = std::thread::hardware_concurrency();
+
+        if (count == 0)
+            count = 1;
+
+        for (std::size_t i = 0; i < count; i++)
+            pool.push_back(std::thread(&Executor::run, this));
+    }
+
+    Executor(const Executor &) = delete;
+    Executor &operator=(const Executor &) = delete;
+
+    /**
+     * @brief Finishes all posted tasks and stops the pool.
+     * @details Every service attached to the executor has to be joined
+     *          before.
+     */
+    ~Executor()
+    {
+        tasks.close();
+
+        for (std::thread &thread : pool)
+            thread.join();
+    }
+
+    /**
+     * @brief Queues a task for one of the pool threads.
+     * @details The task queue is unbounded, so posting never blocks.
+     */
+    void post(Job &&task)
+    {
+        tasks.push(std::move(task));
+    }
+
+    /**
+     * @brief Getter for the size of the pool.
+     */
+    std::size_t threads() const
+    {
+        return pool.size();
+    }
+
+private:
+    void run()
+    {
+        Job task;
+
+        while (tasks.pop(&task))
+        {
+            task();
+            task = Job();
+        }
+    }
+
+    BlockingQueue<Job> tasks;       ///< Posted tasks, unbounded.
+    std::vector<std::thread> pool;  ///< The pool threads.
+};
+
+} // namespace NSA
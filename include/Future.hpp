@@ -0,0 +1,774 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Job.hpp"
+#include "SlabPool.hpp"
+
+namespace NSA
+{
+
+template <class T> class Promise;
+template <class T> class Future;
+
+/*!
+ * @brief The state shared by a promise and its futures.
+ * @details Holds the value or the exception, the synchronisation for
+ *          waiting futures, optional continuations and an intrusive
+ *          reference count of all handles. Everything lives in a
+ *          single block, which comes from a SlabPool if one is given.
+ *          Promise and Future are the only users of this class.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class T>
+class SharedState
+{
+public:
+    /// Type of the stored value. A void state stores a dummy flag.
+    typedef typename std::conditional<std::is_void<T>::value, bool, T>::type Value;
+
+    /**
+     * @brief Creates a state referenced by a single promise.
+     * @param pool The pool to allocate from. May be nullptr.
+     */
+    static SharedState *create(SlabPool *pool)
+    {
+        void *memory = pool && SlabPool::fits<SharedState>() ? pool->allocate() : nullptr;
+
+        if (memory)
+            return new (memory) SharedState(pool);
+
+        return new SharedState(nullptr);
+    }
+
+    void retainPromise()
+    {
+        promises.fetch_add(1, std::memory_order_relaxed);
+        retain();
+    }
+
+    void releasePromise()
+    {
+        if (promises.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+            status.load(std::memory_order_acquire) == Pending)
+        {
+            try
+            {
+                setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+            }
+            catch (const std::future_error &)
+            {}
+        }
+
+        release();
+    }
+
+    void retain()
+    {
+        references.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release()
+    {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            destroy();
+    }
+
+    template <class... Args>
+    void setValue(Args &&...args)
+    {
+        claim();
+        new (storage) Value(std::forward<Args>(args)...);
+        hasValue = true;
+        publish();
+    }
+
+    void setException(std::exception_ptr error)
+    {
+        claim();
+        exception = error;
+        publish();
+    }
+
+    bool ready() const
+    {
+        return status.load(std::memory_order_acquire) == Ready;
+    }
+
+    /**
+     * @brief Stores a job to run as soon as the state is ready.
+     * @details The job runs on the thread which completes the state.
+     *          The first continuation is stored inline, further ones
+     *          go to a list. They run in the order they were stored.
+     * @return False if the state is ready already. The job is not
+     *         stored then and the caller has to run it.
+     */
+    bool setContinuation(Job &&job)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (ready())
+            return false;
+
+        if (!continuation)
+            continuation = std::move(job);
+        else
+            continuations.push_back(std::move(job));
+
+        return true;
+    }
+
+    void wait() const
+    {
+        if (ready())
+            return;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]{return ready();});
+    }
+
+    template <class Clock, class Duration>
+    std::future_status waitUntil(const std::chrono::time_point<Clock, Duration> &timePoint) const
+    {
+        if (ready())
+            return std::future_status::ready;
+
+        std::unique_lock<std::mutex> lock(mutex);
+
+        return condition.wait_until(lock, timePoint, [this]{return ready();}) ?
+            std::future_status::ready : std::future_status::timeout;
+    }
+
+    /**
+     * @brief Moves the result out of a ready state.
+     * @details Rethrows the stored exception, if there is one.
+     */
+    T take()
+    {
+        if (exception)
+            std::rethrow_exception(exception);
+
+        return takeValue(std::is_void<T>());
+    }
+
+private:
+    enum Status
+    {
+        Pending,   ///< Nobody set a result yet.
+        Claimed,   ///< A result is being written.
+        Ready      ///< The result can be read.
+    };
+
+    explicit SharedState(SlabPool *pool) :
+        status(Pending),
+        references(1),
+        promises(1),
+        hasValue(false),
+        pool(pool)
+    {}
+
+    ~SharedState()
+    {
+        if (hasValue)
+            reinterpret_cast<Value *>(storage)->~Value();
+    }
+
+    void destroy()
+    {
+        SlabPool *owner = pool;
+
+        if (owner)
+        {
+            this->~SharedState();
+            owner->deallocate(this);
+        }
+        else
+            delete this;
+    }
+
+    void claim()
+    {
+        int expected = Pending;
+
+        if (!status.compare_exchange_strong(expected, Claimed, std::memory_order_acq_rel))
+            throw std::future_error(std::future_errc::promise_already_satisfied);
+    }
+
+    void publish()
+    {
+        Job next;
+        std::vector<Job> later;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            status.store(Ready, std::memory_order_release);
+            next = std::move(continuation);
+            later.swap(continuations);
+        }
+
+        condition.notify_all();
+
+        if (next)
+            next();
+
+        for (Job &job : later)
+            job();
+    }
+
+    T takeValue(std::false_type)
+    {
+        return std::move(*reinterpret_cast<Value *>(storage));
+    }
+
+    void takeValue(std::true_type)
+    {}
+
+    std::atomic<int> status;
+    std::atomic<std::uint32_t> references;     ///< All promise and future handles.
+    std::atomic<std::uint32_t> promises;       ///< Promise handles only.
+    bool hasValue;
+    SlabPool *pool;                            ///< Source of the memory or nullptr.
+    mutable std::mutex mutex;
+    mutable std::condition_variable condition;
+    std::exception_ptr exception;
+    Job continuation;                          ///< Runs once the state is ready.
+    std::vector<Job> continuations;            ///< Further continuations, rarely used.
+    alignas(Value) unsigned char storage[sizeof(Value)];
+};
+
+/*!
+ * @brief Promise half of a promise future pair.
+ * @details Works like a std::shared_ptr<std::promise<T>>: copies share
+ *          the same state and the operator-> gives access to the
+ *          promise itself, so promise->set_value(...) keeps working.
+ *          If the last promise handle goes away without a result, the
+ *          futures receive a broken_promise std::future_error.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class T>
+class Promise
+{
+public:
+    /**
+     * @brief Creates a new promise with a fresh state.
+     * @param pool The pool to allocate the state from. If nullptr, the
+     *        state is allocated on the heap.
+     */
+    explicit Promise(SlabPool *pool = nullptr) : state(SharedState<T>::create(pool)) {}
+
+    Promise(const Promise &other) : state(other.state)
+    {
+        if (state)
+            state->retainPromise();
+    }
+
+    Promise(Promise &&other) noexcept : state(other.state)
+    {
+        other.state = nullptr;
+    }
+
+    Promise &operator=(Promise other) noexcept
+    {
+        std::swap(state, other.state);
+        return *this;
+    }
+
+    ~Promise()
+    {
+        if (state)
+            state->releasePromise();
+    }
+
+    /**
+     * @brief Stores the value and wakes up every waiting future.
+     * @param args The constructor arguments of the value. Empty for a
+     *        promise of void.
+     */
+    template <class... Args>
+    void set_value(Args &&...args)
+    {
+        state->setValue(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Stores an exception and wakes up every waiting future.
+     */
+    void set_exception(std::exception_ptr error)
+    {
+        state->setException(error);
+    }
+
+    /**
+     * @brief Creates a future sharing the state of this promise.
+     */
+    Future<T> get_future() const
+    {
+        state->retain();
+        return Future<T>(state);
+    }
+
+    Promise *operator->()
+    {
+        return this;
+    }
+
+    explicit operator bool() const
+    {
+        return state != nullptr;
+    }
+
+private:
+    SharedState<T> *state;
+};
+
+/*!
+ * @brief Future half of a promise future pair.
+ * @details Works like a std::shared_ptr<std::future<T>>: copies share
+ *          the same state and the operator-> gives access to the
+ *          future itself, so future->get() keeps working. Like with
+ *          std::future, the value can only be taken once by get.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class T>
+class Future
+{
+public:
+    Future() : state(nullptr) {}
+
+    Future(const Future &other) : state(other.state)
+    {
+        if (state)
+            state->retain();
+    }
+
+    Future(Future &&other) noexcept : state(other.state)
+    {
+        other.state = nullptr;
+    }
+
+    Future &operator=(Future other) noexcept
+    {
+        std::swap(state, other.state);
+        return *this;
+    }
+
+    ~Future()
+    {
+        if (state)
+            state->release();
+    }
+
+    /**
+     * @brief Waits for the result and returns it.
+     * @details Rethrows the exception of the promise, if one was set.
+     */
+    T get()
+    {
+        state->wait();
+        return state->take();
+    }
+
+    void wait() const
+    {
+        state->wait();
+    }
+
+    template <class Rep, class Period>
+    std::future_status wait_for(const std::chrono::duration<Rep, Period> &duration) const
+    {
+        return state->waitUntil(std::chrono::steady_clock::now() + duration);
+    }
+
+    template <class Clock, class Duration>
+    std::future_status wait_until(const std::chrono::time_point<Clock, Duration> &timePoint) const
+    {
+        return state->waitUntil(timePoint);
+    }
+
+    /**
+     * @brief Non blocking check to see if the result is available.
+     */
+    bool ready() const
+    {
+        return state->ready();
+    }
+
+    /**
+     * @brief Stores a job to run as soon as the result is available.
+     * @details The job runs on the thread which sets the result, so it
+     *          should only hand the work on, for example by posting it
+     *          to a service. A future takes several continuations, they
+     *          run in the order they were stored.
+     * @return False if the result is available already. The job is
+     *         not stored then and the caller has to run it.
+     */
+    bool setContinuation(Job &&continuation)
+    {
+        return state->setContinuation(std::move(continuation));
+    }
+
+    /// Decayed return type of a callback passed to then.
+    template <class Callback>
+    using ResultOf = typename std::decay<decltype(std::declval<Callback &>()(std::declval<Future>()))>::type;
+
+    /**
+     * @brief Chains a callback which runs on a service once the result
+     *        is available.
+     * @details The callback receives this future, which is ready then,
+     *          and its return value fulfils the returned future. If the
+     *          callback throws, the returned future receives the
+     *          exception. Nobody polls or blocks: the thread which sets
+     *          the result posts the callback straight to the job list
+     *          of the target, without waiting for room. If the target
+     *          does not take the job, because it is stopped or its job
+     *          list is full, the returned future receives the error of
+     *          the target instead.
+     *          A future can be chained several times and be awaited as
+     *          well, but only one of the callbacks should take the
+     *          result, like get on any future.
+     * @param callback A callable taking a Future<T>.
+     * @param target Anything with a tryPost(Job &&) which cancels the
+     *        jobs it does not take, usually a service.
+     * @return The future of the callback result.
+     */
+    template <class Callback, class Target>
+    Future<ResultOf<Callback>> then(Callback &&callback, Target &target)
+    {
+        Target *service = &target;
+
+        return chain(std::forward<Callback>(callback), [service](Job &&job)
+        {
+            service->tryPost(std::move(job));
+        });
+    }
+
+    /**
+     * @brief Chains a callback which runs on the completing thread.
+     * @details Same as then with a target, but the callback runs right
+     *          where the result is set, so it should be short. This is
+     *          the right choice to combine or convert results.
+     * @param callback A callable taking a Future<T>.
+     * @return The future of the callback result.
+     */
+    template <class Callback>
+    Future<ResultOf<Callback>> then(Callback &&callback)
+    {
+        return chain(std::forward<Callback>(callback), [](Job &&job){job();});
+    }
+
+    bool valid() const
+    {
+        return state != nullptr;
+    }
+
+    Future *operator->()
+    {
+        return this;
+    }
+
+    explicit operator bool() const
+    {
+        return valid();
+    }
+
+private:
+    friend class Promise<T>;
+
+    explicit Future(SharedState<T> *state) : state(state) {}
+
+    template <class Callback, class Dispatch>
+    Future<ResultOf<Callback>> chain(Callback &&callback, Dispatch dispatch)
+    {
+        typedef ResultOf<Callback> Result;
+        typedef typename std::decay<Callback>::type Function;
+
+        Promise<Result> next;
+        Future<Result> result = next.get_future();
+
+        // The step holds a handle of this future until it ran. Completing
+        // the state always takes and runs the continuation, which breaks
+        // the cycle again.
+        Step<Result, Function> step{Function(std::forward<Callback>(callback)), *this, next};
+
+        Job continuation([step = std::move(step), dispatch]() mutable
+        {
+            dispatch(Job(std::move(step)));
+        });
+
+        if (!setContinuation(std::move(continuation)))
+            continuation();
+
+        return result;
+    }
+
+    /// The callback of then, with the promise of its result.
+    template <class Result, class Function>
+    struct Step
+    {
+        Function function;
+        Future self;
+        Promise<Result> next;
+
+        void operator()()
+        {
+            fulfil(next, function, std::move(self), std::is_void<Result>());
+        }
+
+        /// The target did not take the callback.
+        void cancel(std::exception_ptr error)
+        {
+            next.set_exception(error);
+        }
+    };
+
+    template <class Result, class Function>
+    static void fulfil(Promise<Result> &promise, Function &function, Future &&ready, std::false_type)
+    {
+        try
+        {
+            promise.set_value(function(std::move(ready)));
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+    template <class Result, class Function>
+    static void fulfil(Promise<Result> &promise, Function &function, Future &&ready, std::true_type)
+    {
+        try
+        {
+            function(std::move(ready));
+            promise.set_value();
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+    SharedState<T> *state;
+};
+
+/*!
+ * @brief Result of when_any.
+ * @details Holds every future passed to when_any together with the
+ *          position of the one which became ready first.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class Sequence>
+struct WhenAnyResult
+{
+    std::size_t index;  ///< Position of the first ready future.
+    Sequence futures;   ///< All futures, in the order they were passed.
+};
+
+/**
+ * @brief Runs a callback as soon as a future is ready.
+ * @details Runs it right away if the future is ready already.
+ */
+template <class T, class Callback>
+void onReady(Future<T> future, Callback &&callback)
+{
+    Job job(std::forward<Callback>(callback));
+
+    if (!future.setContinuation(std::move(job)))
+        job();
+}
+
+/*!
+ * @brief Bookkeeping of when_all.
+ * @details Counts the futures which are not ready yet. The last one
+ *          fulfils the promise with all of them.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class Sequence>
+class WhenAllState
+{
+public:
+    WhenAllState(Sequence futures, const std::size_t count) :
+        futures(std::move(futures)),
+        remaining(count)
+    {}
+
+    Future<Sequence> get_future() const
+    {
+        return promise.get_future();
+    }
+
+    void arrive()
+    {
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            promise.set_value(std::move(futures));
+    }
+
+private:
+    Sequence futures;
+    std::atomic<std::size_t> remaining;     ///< Futures which are not ready.
+    Promise<Sequence> promise;
+};
+
+/*!
+ * @brief Bookkeeping of when_any.
+ * @details The first ready future fulfils the promise, every later one
+ *          is ignored.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class Sequence>
+class WhenAnyState
+{
+public:
+    explicit WhenAnyState(Sequence futures) :
+        futures(std::move(futures)),
+        done(false)
+    {}
+
+    Future<WhenAnyResult<Sequence>> get_future() const
+    {
+        return promise.get_future();
+    }
+
+    void arrive(const std::size_t index)
+    {
+        if (!done.exchange(true, std::memory_order_acq_rel))
+            promise.set_value(WhenAnyResult<Sequence>{index, std::move(futures)});
+    }
+
+private:
+    Sequence futures;
+    std::atomic<bool> done;                 ///< Set by the first ready future.
+    Promise<WhenAnyResult<Sequence>> promise;
+};
+
+/**
+ * @brief Creates a future which is ready once all given futures are.
+ * @details The futures are handed back in a tuple, so each of them can
+ *          be read with get without blocking. Exceptions stay in the
+ *          future which holds them. The returned future becomes ready
+ *          on the thread which completes the last future; chain it with
+ *          then to continue on a service.
+ *          Uses the continuation of every given future.
+ */
+template <class... Ts>
+Future<std::tuple<Future<Ts>...>> when_all(Future<Ts>... futures)
+{
+    typedef std::tuple<Future<Ts>...> Sequence;
+
+    // One extra arrival for this function, so an empty list completes too.
+    auto context = std::make_shared<WhenAllState<Sequence>>(Sequence(futures...), sizeof...(Ts) + 1);
+    Future<Sequence> result = context->get_future();
+
+    (onReady(std::move(futures), [context]{context->arrive();}), ...);
+    context->arrive();
+
+    return result;
+}
+
+/**
+ * @brief Creates a future which is ready once all futures of a range are.
+ * @details Same as the variadic when_all, but for a range of futures of
+ *          the same type. The futures are handed back in a vector.
+ */
+template <class InputIt>
+Future<std::vector<typename std::iterator_traits<InputIt>::value_type>> when_all(InputIt first, InputIt last)
+{
+    typedef std::vector<typename std::iterator_traits<InputIt>::value_type> Sequence;
+
+    Sequence futures(first, last);
+    const std::size_t count = futures.size();
+    auto context = std::make_shared<WhenAllState<Sequence>>(futures, count + 1);
+    Future<Sequence> result = context->get_future();
+
+    for (std::size_t i = 0; i < count; i++)
+        onReady(std::move(futures[i]), [context]{context->arrive();});
+
+    context->arrive();
+
+    return result;
+}
+
+template <class Sequence, class... Ts, std::size_t... Indices>
+void subscribeAny(const std::shared_ptr<WhenAnyState<Sequence>> &context,
+    std::tuple<Future<Ts>...> &futures, std::index_sequence<Indices...>)
+{
+    (onReady(std::move(std::get<Indices>(futures)), [context]{context->arrive(Indices);}), ...);
+}
+
+/**
+ * @brief Creates a future which is ready once any given future is.
+ * @details The result holds all futures and the index of the first
+ *          ready one. The others keep running. The returned future
+ *          becomes ready on the thread which completes the first
+ *          future; chain it with then to continue on a service.
+ *          Without any future, the index is std::size_t(-1).
+ *          Uses the continuation of every given future.
+ */
+template <class... Ts>
+Future<WhenAnyResult<std::tuple<Future<Ts>...>>> when_any(Future<Ts>... futures)
+{
+    typedef std::tuple<Future<Ts>...> Sequence;
+
+    auto context = std::make_shared<WhenAnyState<Sequence>>(Sequence(futures...));
+    Future<WhenAnyResult<Sequence>> result = context->get_future();
+    Sequence subscribed(std::move(futures)...);
+
+    subscribeAny(context, subscribed, std::index_sequence_for<Ts...>());
+
+    if (sizeof...(Ts) == 0)
+        context->arrive(static_cast<std::size_t>(-1));
+
+    return result;
+}
+
+/**
+ * @brief Creates a future which is ready once any future of a range is.
+ * @details Same as the variadic when_any, but for a range of futures of
+ *          the same type. The futures are handed back in a vector.
+ */
+template <class InputIt>
+Future<WhenAnyResult<std::vector<typename std::iterator_traits<InputIt>::value_type>>>
+    when_any(InputIt first, InputIt last)
+{
+    typedef std::vector<typename std::iterator_traits<InputIt>::value_type> Sequence;
+
+    Sequence futures(first, last);
+    const std::size_t count = futures.size();
+    auto context = std::make_shared<WhenAnyState<Sequence>>(futures);
+    Future<WhenAnyResult<Sequence>> result = context->get_future();
+
+    for (std::size_t i = 0; i < count; i++)
+        onReady(std::move(futures[i]), [context, i]{context->arrive(i);});
+
+    if (count == 0)
+        context->arrive(static_cast<std::size_t>(-1));
+
+    return result;
+}
+
+} // namespace NSA
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace NSA
+{
+
+/*!
+ * @brief Move-only callable without heap allocation.
+ * @details A Job replaces std::function<void()> in the job list of a
+ *          service. It can hold any callable without arguments, but
+ *          unlike std::function it never copies. Callables up to
+ *          InlineSize bytes are stored inside the job itself, which is
+ *          enough for a promise plus a handful of bound arguments.
+ *          Only larger callables, or callables which might throw while
+ *          being moved, are placed on the heap.
+ *          A job which is dropped instead of run can be cancelled. A
+ *          callable with a cancel(std::exception_ptr) member gets the
+ *          reason, so it can fail its promise.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+class Job
+{
+public:
+    /// Bytes of callable storage inside the job.
+    static constexpr std::size_t InlineSize = 15 * sizeof(void *);
+
+    /**
+     * @brief Creates an empty job. Calling it is undefined.
+     */
+    Job() noexcept : operations(nullptr) {}
+
+    /**
+     * @brief Wraps a callable into a job.
+     * @param function Any callable taking no arguments.
+     */
+    template <class Function, class = typename std::enable_if<
+        !std::is_same<typename std::decay<Function>::type, Job>::value>::type>
+    Job(Function &&function) : operations(nullptr)
+    {
+        typedef typename std::decay<Function>::type Callable;
+
+        construct<Callable>(std::forward<Function>(function),
+            std::integral_constant<bool, fitsInline<Callable>()>());
+    }
+
+    Job(Job &&other) noexcept : operations(other.operations)
+    {
+        if (operations)
+            operations->move(storage, other.storage);
+
+        other.operations = nullptr;
+    }
+
+    Job &operator=(Job &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            operations = other.operations;
+
+            if (operations)
+                operations->move(storage, other.storage);
+
+            other.operations = nullptr;
+        }
+
+        return *this;
+    }
+
+    Job(const Job &) = delete;
+    Job &operator=(const Job &) = delete;
+
+    ~Job()
+    {
+        reset();
+    }
+
+    /**
+     * @brief Runs the wrapped callable.
+     */
+    void operator()()
+    {
+        operations->invoke(storage);
+    }
+
+    /**
+     * @brief Drops the job without running it.
+     * @details Hands the error to the callable, if it has a
+     *          cancel(std::exception_ptr) member. Any other callable is
+     *          simply destroyed. The job is empty afterwards.
+     * @param error The reason for the cancellation.
+     */
+    void cancel(std::exception_ptr error)
+    {
+        if (operations)
+            operations->cancel(storage, error);
+
+        reset();
+    }
+
+    /**
+     * @brief Check to see if the job holds a callable.
+     */
+    explicit operator bool() const
+    {
+        return operations != nullptr;
+    }
+
+    /**
+     * @brief Check to see if a callable is stored without allocation.
+     * @tparam Callable The decayed type of the callable.
+     */
+    template <class Callable>
+    static constexpr bool fitsInline()
+    {
+        return sizeof(Callable) <= InlineSize &&
+            alignof(Callable) <= alignof(void *) &&
+            std::is_nothrow_move_constructible<Callable>::value;
+    }
+
+private:
+    struct Operations
+    {
+        void (*invoke)(void *self);
+        void (*move)(void *dst, void *src);
+        void (*destroy)(void *self);
+        void (*cancel)(void *self, std::exception_ptr error);
+    };
+
+    template <class Callable, class = void>
+    struct Cancel
+    {
+        static void apply(Callable &, std::exception_ptr)
+        {}
+    };
+
+    template <class Callable>
+    struct Cancel<Callable, decltype(void(std::declval<Callable &>().cancel(std::exception_ptr())))>
+    {
+        static void apply(Callable &callable, std::exception_ptr error)
+        {
+            callable.cancel(error);
+        }
+    };
+
+    template <class Callable>
+    struct InlineOperations
+    {
+        static void invoke(void *self)
+        {
+            (*static_cast<Callable *>(self))();
+        }
+
+        static void move(void *dst, void *src)
+        {
+            new (dst) Callable(std::move(*static_cast<Callable *>(src)));
+            static_cast<Callable *>(src)->~Callable();
+        }
+
+        static void destroy(void *self)
+        {
+            static_cast<Callable *>(self)->~Callable();
+        }
+
+        static void cancel(void *self, std::exception_ptr error)
+        {
+            Cancel<Callable>::apply(*static_cast<Callable *>(self), error);
+        }
+
+        static constexpr Operations table = {invoke, move, destroy, cancel};
+    };
+
+    template <class Callable>
+    struct HeapOperations
+    {
+        static void invoke(void *self)
+        {
+            (**static_cast<Callable **>(self))();
+        }
+
+        static void move(void *dst, void *src)
+        {
+            *static_cast<Callable **>(dst) = *static_cast<Callable **>(src);
+        }
+
+        static void destroy(void *self)
+        {
+            delete *static_cast<Callable **>(self);
+        }
+
+        static void cancel(void *self, std::exception_ptr error)
+        {
+            Cancel<Callable>::apply(**static_cast<Callable **>(self), error);
+        }
+
+        static constexpr Operations table = {invoke, move, destroy, cancel};
+    };
+
+    template <class Callable, class Function>
+    void construct(Function &&function, std::true_type)
+    {
+        new (storage) Callable(std::forward<Function>(function));
+        operations = &InlineOperations<Callable>::table;
+    }
+
+    template <class Callable, class Function>
+    void construct(Function &&function, std::false_type)
+    {
+        *reinterpret_cast<Callable **>(storage) = new Callable(std::forward<Function>(function));
+        operations = &HeapOperations<Callable>::table;
+    }
+
+    void reset()
+    {
+        if (operations)
+            operations->destroy(storage);
+
+        operations = nullptr;
+    }
+
+    alignas(void *) unsigned char storage[InlineSize];
+    const Operations *operations;
+};
+
+template <class Callable>
+constexpr Job::Operations Job::InlineOperations<Callable>::table;
+
+template <class Callable>
+constexpr Job::Operations Job::HeapOperations<Callable>::table;
+
+} // namespace NSA
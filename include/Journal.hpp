@@ -0,0 +1,622 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace NSA
+{
+
+/// When the records of a Journal reach the disk.
+enum class JournalSync
+{
+    None,  ///< Whenever the kernel writes them back. Survives a crash of the process only.
+    Group  ///< Before the append returns. Concurrent appends share a single msync.
+};
+
+/// Layout and durability of a Journal.
+struct JournalOptions
+{
+    std::size_t segmentSize = 16 << 20;     ///< Bytes per segment file.
+    std::size_t segments = 4;               ///< Segment files in the ring.
+    JournalSync sync = JournalSync::Group;  ///< When an append is durable.
+};
+
+/**
+ * @brief Turns the elements of a journaled queue into records and back.
+ * @details Trivially copyable types are stored byte by byte. Other types
+ * need a specialization with the same two functions.
+ */
+template <class T, class = void>
+struct JournalCodec
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Specialize NSA::JournalCodec for this type");
+
+    static void encode(const T &item, std::string &record)
+    {
+        record.assign(reinterpret_cast<const char *>(&item), sizeof(T));
+    }
+
+    /**
+     * @return False if the record does not hold a T.
+     */
+    static bool decode(const char *data, const std::size_t size, T &item)
+    {
+        if (size != sizeof(T))
+            return false;
+
+        std::memcpy(static_cast<void *>(&item), data, size);
+        return true;
+    }
+};
+
+template <>
+struct JournalCodec<std::string>
+{
+    static void encode(const std::string &item, std::string &record)
+    {
+        record = item;
+    }
+
+    static bool decode(const char *data, const std::size_t size, std::string &item)
+    {
+        item.assign(data, size);
+        return true;
+    }
+};
+
+/*!
+ * @brief Append only log of records in a ring of memory mapped files.
+ * @details The journal keeps a queue on disk: records are appended at
+ *          the tail and consumed in the same order at the head. The
+ *          records live in a fixed amount of segment files of a fixed
+ *          size, which are mapped into memory, so appending a record
+ *          is a copy without a system call. Once every record of a
+ *          segment is consumed, the segment is reused. If the ring is
+ *          full, appends fail until the head moves on.
+ *
+ *          Each record carries its sequence number and a CRC32C of the
+ *          payload, so a record which was only partly written when the
+ *          process died ends the log. The sequence number of the first
+ *          unconsumed record is kept in a head file of its own.
+ *
+ *          With JournalSync::Group, commit waits until a record is on
+ *          disk. The first waiting thread syncs everything appended so
+ *          far, and the threads arriving meanwhile wait for it and
+ *          share the next sync, so a burst of appends costs a single
+ *          msync instead of one each.
+ *
+ *          Opening a journal replays the unconsumed records. It only
+ *          reads from the segment holding the head onwards, so
+ *          consumed records cost nothing, however long the log got.
+ *          Consuming is persisted along with the next commit, a crash
+ *          may replay the last records consumed before it again.
+ *
+ *          Append and consume may be called from any thread. Callers
+ *          which need the order of the journal to match another queue,
+ *          like BlockingQueue, call both under the lock of that queue.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+class Journal
+{
+public:
+    Journal() :
+        headFile(-1),
+        head(nullptr),
+        writeSegment(0),
+        writeOffset(0),
+        switches(0),
+        nextSequence(1),
+        headSequence(1),
+        committing(false),
+        durable(0),
+        syncedSegment(0),
+        syncedOffset(0),
+        syncedSwitches(0)
+    {}
+
+    ~Journal()
+    {
+#if defined(__linux__)
+        for (std::size_t i = 0; i < maps.size(); i++)
+        {
+            msync(maps[i], options.segmentSize, MS_SYNC);
+            munmap(maps[i], options.segmentSize);
+            ::close(files[i]);
+        }
+
+        if (head)
+        {
+            msync(head, HeadSize, MS_SYNC);
+            munmap(head, HeadSize);
+            ::close(headFile);
+        }
+#endif
+    }
+
+    Journal(const Journal &) = delete;
+    Journal &operator=(const Journal &) = delete;
+
+    /**
+     * @brief Opens or creates the journal in a directory and replays it.
+     * @details The segment size of an existing journal has to match.
+     * @param directory An existing directory, which holds the files.
+     * @param options The layout and durability.
+     * @param replay Called with the payload and size of every
+     *        unconsumed record, in order. Returns false to abort.
+     * @return False if the files cannot be opened, or replay aborted.
+     */
+    template <class Callback>
+    bool open(const std::string &directory, const JournalOptions &options, Callback replay)
+    {
+#if defined(__linux__)
+        this->options = options;
+        this->options.segments = options.segments < 1 ? 1 : options.segments;
+
+        const long page = sysconf(_SC_PAGESIZE);
+        this->options.segmentSize = (options.segmentSize + page - 1) / page * page;
+
+        if (!mapHead(directory + "/head"))
+            return false;
+
+        for (std::size_t i = 0; i < this->options.segments; i++)
+            if (!mapSegment(directory + "/segment-" + std::to_string(i)))
+                return false;
+
+        return recover(replay);
+#else
+        (void)directory; (void)options; (void)replay;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Appends a record.
+     * @details Only copies the record into the mapping, see commit.
+     * @return The sequence number of the record. Zero if the ring is
+     *         full, or the record is larger than a segment.
+     */
+    std::uint64_t append(const void *data, const std::size_t size)
+    {
+        const std::size_t bytes = recordBytes(size);
+
+        if (maps.empty() || bytes > options.segmentSize - sizeof(SegmentHeader))
+            return 0;
+
+        std::lock_guard<std::mutex> lock(appendMutex);
+
+        if (writeOffset + bytes > options.segmentSize && !nextSegment())
+            return 0;
+
+        unsigned char *at = maps[writeSegment] + writeOffset;
+        RecordHeader record;
+        record.size = static_cast<std::uint32_t>(size);
+        record.sequence = nextSequence;
+        record.checksum = checksum(record.sequence, data, size);
+
+        std::memcpy(at + sizeof(RecordHeader), data, size);
+        std::memcpy(at, &record, sizeof(RecordHeader));
+
+        writeOffset += bytes;
+        return nextSequence++;
+    }
+
+    /**
+     * @brief Marks the oldest records as consumed.
+     */
+    void consume(const std::size_t count)
+    {
+        std::lock_guard<std::mutex> lock(appendMutex);
+
+        headSequence += count;
+
+        if (head)
+            head->consumed = headSequence;
+    }
+
+    /**
+     * @brief Waits until a record is on disk.
+     * @details Does nothing with JournalSync::None.
+     * @param sequence The sequence number of the record.
+     */
+    void commit(const std::uint64_t sequence)
+    {
+        if (options.sync == JournalSync::Group)
+            sync(sequence);
+    }
+
+    /**
+     * @brief Writes every record and the head to disk.
+     */
+    void flush()
+    {
+        std::uint64_t last = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(appendMutex);
+            last = nextSequence - 1;
+        }
+
+        sync(last);
+    }
+
+    /**
+     * @brief Getter for the amount of unconsumed records.
+     */
+    std::size_t pending()
+    {
+        std::lock_guard<std::mutex> lock(appendMutex);
+        return nextSequence - headSequence;
+    }
+
+private:
+    static constexpr std::uint64_t Magic = 0x4c4e524a41534e;  // "NSAJRNL"
+    static constexpr std::size_t HeadSize = 4096;
+
+    struct SegmentHeader
+    {
+        std::uint64_t magic;
+        std::uint64_t first;    ///< Sequence number of the first record.
+    };
+
+    struct RecordHeader
+    {
+        std::uint32_t size;     ///< Payload bytes.
+        std::uint32_t checksum; ///< CRC32C of the sequence number and the payload.
+        std::uint64_t sequence;
+    };
+
+    struct Head
+    {
+        std::uint64_t magic;
+        std::uint64_t consumed; ///< Sequence number of the first unconsumed record.
+    };
+
+    /**
+     * @brief Bytes of a record, padded so the next header is aligned.
+     */
+    static std::size_t recordBytes(const std::size_t size)
+    {
+        return (sizeof(RecordHeader) + size + 7) & ~std::size_t(7);
+    }
+
+    static std::uint32_t checksum(const std::uint64_t sequence, const void *data, const std::size_t size)
+    {
+        std::uint32_t crc = crc32c(~0u, &sequence, sizeof(sequence));
+        return ~crc32c(crc, data, size);
+    }
+
+    /**
+     * @brief Bytewise CRC32C, the Castagnoli polynomial.
+     */
+    static std::uint32_t crc32c(std::uint32_t crc, const void *data, const std::size_t size)
+    {
+        static const std::vector<std::uint32_t> table = []
+        {
+            std::vector<std::uint32_t> entries(256);
+
+            for (std::uint32_t i = 0; i < 256; i++)
+            {
+                std::uint32_t entry = i;
+
+                for (int bit = 0; bit < 8; bit++)
+                    entry = entry & 1 ? (entry >> 1) ^ 0x82f63b78 : entry >> 1;
+
+                entries[i] = entry;
+            }
+
+            return entries;
+        }();
+
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+
+        for (std::size_t i = 0; i < size; i++)
+            crc = table[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+
+        return crc;
+    }
+
+#if defined(__linux__)
+    /**
+     * @brief Maps a file of a given size, and creates it if needed.
+     * @return The mapping, or nullptr.
+     */
+    static unsigned char *mapFile(const std::string &path, const std::size_t size, int &file)
+    {
+        file = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+        if (file < 0)
+            return nullptr;
+
+        struct stat status;
+
+        if (fstat(file, &status) != 0 || (status.st_size != 0 && static_cast<std::size_t>(status.st_size) != size)
+            || (status.st_size == 0 && (ftruncate(file, size) != 0 || fsync(file) != 0)))
+        {
+            ::close(file);
+            return nullptr;
+        }
+
+        void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+
+        if (map == MAP_FAILED)
+        {
+            ::close(file);
+            return nullptr;
+        }
+
+        return static_cast<unsigned char *>(map);
+    }
+
+    bool mapHead(const std::string &path)
+    {
+        unsigned char *map = mapFile(path, HeadSize, headFile);
+
+        if (map == nullptr)
+            return false;
+
+        head = reinterpret_cast<Head *>(map);
+
+        if (head->magic != Magic)
+        {
+            head->consumed = 1;
+            head->magic = Magic;
+        }
+
+        return true;
+    }
+
+    bool mapSegment(const std::string &path)
+    {
+        int file = -1;
+        unsigned char *map = mapFile(path, options.segmentSize, file);
+
+        if (map == nullptr)
+            return false;
+
+        maps.push_back(map);
+        files.push_back(file);
+
+        const SegmentHeader *header = reinterpret_cast<const SegmentHeader *>(map);
+        firsts.push_back(header->magic == Magic ? header->first : 0);
+
+        return true;
+    }
+#endif
+
+    /**
+     * @brief Finds the head and the tail of the log and replays the
+     *        records in between.
+     */
+    template <class Callback>
+    bool recover(Callback &replay)
+    {
+        headSequence = head->consumed;
+
+        // The segment with the newest start at or before the head.
+        std::size_t start = options.segments;
+
+        for (std::size_t i = 0; i < options.segments; i++)
+            if (firsts[i] != 0 && firsts[i] <= headSequence && (start == options.segments || firsts[i] > firsts[start]))
+                start = i;
+
+        std::vector<bool> chained(options.segments, false);
+        std::size_t segment = start == options.segments ? 0 : start;
+        std::uint64_t expected = start == options.segments ? headSequence : firsts[start];
+        std::size_t offset = sizeof(SegmentHeader);
+
+        if (start == options.segments)
+            beginSegment(segment, expected);
+
+        chained[segment] = true;
+
+        for (;;)
+        {
+            const RecordHeader *record = reinterpret_cast<const RecordHeader *>(maps[segment] + offset);
+            const unsigned char *payload = maps[segment] + offset + sizeof(RecordHeader);
+
+            const bool valid = offset + sizeof(RecordHeader) <= options.segmentSize
+                && record->sequence == expected
+                && offset + recordBytes(record->size) <= options.segmentSize
+                && record->checksum == checksum(record->sequence, payload, record->size);
+
+            if (valid)
+            {
+                if (expected >= headSequence && !replay(reinterpret_cast<const char *>(payload), record->size))
+                    return false;
+
+                expected++;
+                offset += recordBytes(record->size);
+                continue;
+            }
+
+            // The log goes on in the next segment, if that one starts
+            // right where this one ended.
+            const std::size_t next = (segment + 1) % options.segments;
+
+            if (chained[next] || firsts[next] != expected)
+                break;
+
+            segment = next;
+            offset = sizeof(SegmentHeader);
+            chained[segment] = true;
+        }
+
+        // Segments off the chain only hold consumed or stale records.
+        for (std::size_t i = 0; i < options.segments; i++)
+            if (!chained[i])
+                firsts[i] = 0;
+
+        writeSegment = segment;
+        writeOffset = offset;
+        nextSequence = expected;
+
+        if (headSequence > nextSequence)
+            headSequence = nextSequence;
+
+        head->consumed = headSequence;
+        durable = nextSequence - 1;
+        syncedSegment = writeSegment;
+        syncedOffset = writeOffset;
+
+        return true;
+    }
+
+    /**
+     * @brief Starts a segment with its header.
+     */
+    void beginSegment(const std::size_t segment, const std::uint64_t first)
+    {
+        SegmentHeader header = {Magic, first};
+        std::memcpy(maps[segment], &header, sizeof(header));
+        firsts[segment] = first;
+    }
+
+    /**
+     * @brief Moves the tail to the oldest segment, if all its records
+     *        are consumed.
+     */
+    bool nextSegment()
+    {
+        const std::size_t next = (writeSegment + 1) % options.segments;
+
+        // With a single segment, the records end at the tail.
+        const std::uint64_t end = next == writeSegment ? nextSequence : firsts[(next + 1) % options.segments];
+
+        if (firsts[next] != 0 && headSequence < end)
+            return false;
+
+        beginSegment(next, nextSequence);
+        writeSegment = next;
+        writeOffset = sizeof(SegmentHeader);
+        switches++;
+
+        return true;
+    }
+
+    /**
+     * @brief Group commit up to a sequence number.
+     */
+    void sync(const std::uint64_t sequence)
+    {
+        std::unique_lock<std::mutex> lock(commitMutex);
+
+        while (durable < sequence)
+        {
+            if (committing)
+            {
+                committed.wait(lock);
+                continue;
+            }
+
+            committing = true;
+            lock.unlock();
+
+            std::uint64_t last = 0;
+            std::size_t segment = 0;
+            std::size_t offset = 0;
+            std::uint64_t switched = 0;
+
+            {
+                std::lock_guard<std::mutex> append(appendMutex);
+                last = nextSequence - 1;
+                segment = writeSegment;
+                offset = writeOffset;
+                switched = switches;
+            }
+
+            syncRange(segment, offset, switched);
+
+            lock.lock();
+            durable = last;
+            committing = false;
+            committed.notify_all();
+        }
+    }
+
+    /**
+     * @brief Syncs everything written since the last sync, up to a
+     *        segment and offset.
+     * @details Only called by the single committing thread.
+     */
+    void syncRange(const std::size_t segment, const std::size_t offset, const std::uint64_t switched)
+    {
+#if defined(__linux__)
+        const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+        auto flush = [this, page](const std::size_t index, const std::size_t from, const std::size_t to)
+        {
+            const std::size_t begin = from / page * page;
+
+            if (to > begin)
+                msync(maps[index] + begin, to - begin, MS_SYNC);
+        };
+
+        if (switched - syncedSwitches >= options.segments)
+        {
+            for (std::size_t i = 0; i < options.segments; i++)
+                flush(i, 0, options.segmentSize);
+        }
+        else
+        {
+            std::size_t current = syncedSegment;
+            std::size_t from = syncedOffset;
+
+            for (std::uint64_t i = syncedSwitches; i < switched; i++)
+            {
+                flush(current, from, options.segmentSize);
+                current = (current + 1) % options.segments;
+                from = 0;
+            }
+
+            flush(current, from, offset);
+        }
+
+        msync(head, HeadSize, MS_ASYNC);
+#else
+        (void)offset;
+#endif
+
+        syncedSegment = segment;
+        syncedOffset = offset;
+        syncedSwitches = switched;
+    }
+
+    JournalOptions options;
+    std::vector<unsigned char *> maps;  ///< Mapping per segment.
+    std::vector<int> files;             ///< File per segment.
+    std::vector<std::uint64_t> firsts;  ///< First sequence number per segment, zero if unused.
+    int headFile;
+    Head *head;                         ///< Mapping of the head file.
+
+    std::mutex appendMutex;             ///< Guards the tail and the head.
+    std::size_t writeSegment;           ///< Segment of the tail.
+    std::size_t writeOffset;            ///< Offset of the tail.
+    std::uint64_t switches;             ///< Segments started so far.
+    std::uint64_t nextSequence;         ///< Sequence number of the next record.
+    std::uint64_t headSequence;         ///< Sequence number of the first unconsumed record.
+
+    std::mutex commitMutex;             ///< Guards the group commit.
+    std::condition_variable committed;  ///< Wakes the threads of a group.
+    bool committing;                    ///< A thread syncs right now.
+    std::uint64_t durable;              ///< Last sequence number on disk.
+    std::size_t syncedSegment;          ///< Tail at the last sync.
+    std::size_t syncedOffset;
+    std::uint64_t syncedSwitches;
+};
+
+} // namespace NSA
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "RingBuffer.hpp"
+
+/**
+ * @brief Compile time switch for the instrumentation.
+ * @details Define NSA_DISABLE_METRICS before including any header of
+ * the library to remove every time stamp, histogram and counter from
+ * the hot paths. The snapshot API stays available, but reports zeros.
+ */
+#ifndef NSA_DISABLE_METRICS
+#define NSA_METRICS_ENABLED 1
+#else
+#define NSA_METRICS_ENABLED 0
+#endif
+
+namespace NSA
+{
+
+/**
+ * @brief Monotonic time stamp in nanoseconds.
+ */
+inline std::int64_t metricsClock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*!
+ * @brief Copy of a LatencyHistogram at one point in time.
+ * @details Values are nanoseconds. Percentiles are accurate to about
+ *          three percent, like the buckets of the histogram.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+struct HistogramSnapshot
+{
+    std::vector<std::uint64_t> counts;  ///< Samples per bucket.
+    std::uint64_t count = 0;            ///< Samples in all buckets.
+    std::int64_t sum = 0;               ///< Sum of all samples.
+    std::int64_t max = 0;               ///< Largest sample.
+
+    /**
+     * @brief Getter for the value below which a share of the samples lie.
+     * @param percent The share in percent, for example 99.9.
+     * @return The upper bound of the bucket holding the percentile, or
+     *         zero without samples.
+     */
+    std::int64_t percentile(const double percent) const;
+
+    std::int64_t mean() const
+    {
+        return count ? sum / static_cast<std::int64_t>(count) : 0;
+    }
+
+    /**
+     * @brief Adds the samples of another snapshot.
+     */
+    void merge(const HistogramSnapshot &other);
+};
+
+/*!
+ * @brief Lock-free latency histogram with logarithmic buckets.
+ * @details Works like an HDR histogram: values below 32 get a bucket
+ *          each, every larger power of two is split into 16 linear
+ *          buckets. This keeps the relative error of every bucket
+ *          below 1/16 while the whole range from a nanosecond up to
+ *          about 18 minutes fits into a few hundred counters. Larger
+ *          values land in the last bucket.
+ *          Recording is a couple of relaxed atomic increments, so
+ *          writers never wait and a snapshot can be taken at any time.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned LinearBits = 5;                 ///< Values with a bucket each.
+    static constexpr unsigned MaxMagnitude = 40;              ///< Highest tracked power of two.
+    static constexpr std::size_t Buckets =
+        (std::size_t(1) << LinearBits) + (MaxMagnitude - LinearBits + 1) * (std::size_t(1) << (LinearBits - 1));
+
+    LatencyHistogram() : sum(0), max(0)
+    {
+        for (std::atomic<std::uint64_t> &count : counts)
+            count.store(0, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    /**
+     * @brief Adds a sample. Negative values count as zero.
+     */
+    void record(const std::int64_t value)
+    {
+        const std::uint64_t sample = value > 0 ? static_cast<std::uint64_t>(value) : 0;
+
+        counts[bucketOf(sample)].fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(static_cast<std::int64_t>(sample), std::memory_order_relaxed);
+
+        std::int64_t largest = max.load(std::memory_order_relaxed);
+
+        while (static_cast<std::int64_t>(sample) > largest &&
+            !max.compare_exchange_weak(largest, static_cast<std::int64_t>(sample), std::memory_order_relaxed))
+        {}
+    }
+
+    HistogramSnapshot snapshot() const
+    {
+        HistogramSnapshot copy;
+        copy.counts.resize(Buckets);
+
+        for (std::size_t i = 0; i < Buckets; i++)
+        {
+            copy.counts[i] = counts[i].load(std::memory_order_relaxed);
+            copy.count += copy.counts[i];
+        }
+
+        copy.sum = sum.load(std::memory_order_relaxed);
+        copy.max = max.load(std::memory_order_relaxed);
+
+        return copy;
+    }
+
+    static std::size_t bucketOf(const std::uint64_t value)
+    {
+        const std::uint64_t linear = std::uint64_t(1) << LinearBits;
+
+        if (value < linear)
+            return static_cast<std::size_t>(value);
+
+        const unsigned magnitude = 63 - static_cast<unsigned>(__builtin_clzll(value));
+
+        if (magnitude > MaxMagnitude)
+            return Buckets - 1;
+
+        const unsigned shift = magnitude - (LinearBits - 1);
+        const std::uint64_t half = linear / 2;
+
+        return static_cast<std::size_t>(linear + (magnitude - LinearBits) * half + ((value >> shift) - half));
+    }
+
+    /**
+     * @brief Getter for the largest value of a bucket.
+     */
+    static std::int64_t highestOf(const std::size_t bucket)
+    {
+        const std::size_t linear = std::size_t(1) << LinearBits;
+
+        if (bucket < linear)
+            return static_cast<std::int64_t>(bucket);
+
+        const std::size_t half = linear / 2;
+        const std::size_t magnitude = LinearBits + (bucket - linear) / half;
+        const std::uint64_t top = half + (bucket - linear) % half;
+
+        return static_cast<std::int64_t>(((top + 1) << (magnitude - (LinearBits - 1))) - 1);
+    }
+
+private:
+    std::atomic<std::uint64_t> counts[Buckets];
+    std::atomic<std::int64_t> sum;
+    std::atomic<std::int64_t> max;
+};
+
+inline std::int64_t HistogramSnapshot::percentile(const double percent) const
+{
+    if (count == 0)
+        return 0;
+
+    std::uint64_t rank = static_cast<std::uint64_t>(percent / 100.0 * static_cast<double>(count) + 0.5);
+
+    if (rank < 1)
+        rank = 1;
+
+    std::uint64_t seen = 0;
+
+    for (std::size_t i = 0; i < counts.size(); i++)
+    {
+        seen += counts[i];
+
+        if (seen >= rank)
+        {
+            const std::int64_t highest = LatencyHistogram::highestOf(i);
+            return highest < max ? highest : max;
+        }
+    }
+
+    return max;
+}
+
+inline void HistogramSnapshot::merge(const HistogramSnapshot &other)
+{
+    if (counts.size() < other.counts.size())
+        counts.resize(other.counts.size());
+
+    for (std::size_t i = 0; i < other.counts.size(); i++)
+        counts[i] += other.counts[i];
+
+    count += other.count;
+    sum += other.sum;
+
+    if (other.max > max)
+        max = other.max;
+}
+
+/*!
+ * @brief Instrumentation of a single worker.
+ * @details Every worker writes to its own block, so workers do not
+ *          share cache lines while they record.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+struct alignas(CacheLineSize) WorkerMetrics
+{
+    LatencyHistogram queued;                    ///< Enqueue to dequeue.
+    LatencyHistogram running;                   ///< Dequeue to completion.
+    LatencyHistogram response;                  ///< Enqueue to completion.
+    std::atomic<std::int64_t> busy{0};          ///< Nanoseconds spent in jobs.
+    std::atomic<std::int64_t> idle{0};          ///< Nanoseconds spent waiting for jobs.
+    std::atomic<std::uint64_t> jobs{0};         ///< Finished jobs.
+
+    /**
+     * @brief Records a finished job.
+     * @param enqueued Time stamp of the submission.
+     * @param dequeued Time stamp of the dequeue.
+     * @param completed Time stamp of the completion.
+     */
+    void recordJob(const std::int64_t enqueued, const std::int64_t dequeued, const std::int64_t completed)
+    {
+        queued.record(dequeued - enqueued);
+        running.record(completed - dequeued);
+        response.record(completed - enqueued);
+        busy.fetch_add(completed - dequeued, std::memory_order_relaxed);
+        jobs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void recordIdle(const std::int64_t nanoseconds)
+    {
+        idle.fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+};
+
+/// Busy and idle time of a single worker.
+struct WorkerSnapshot
+{
+    std::chrono::nanoseconds busy;
+    std::chrono::nanoseconds idle;
+    std::uint64_t jobs;
+};
+
+/*!
+ * @brief Sample of the instrumentation of a service.
+ * @details Taken by Service::metrics while the service keeps running.
+ *          The histograms merge the samples of all workers.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+struct MetricsSnapshot
+{
+    HistogramSnapshot queued;               ///< Time a job waited in the job list.
+    HistogramSnapshot running;              ///< Time a job ran on a worker.
+    HistogramSnapshot response;             ///< Time from submission to completion.
+    std::vector<WorkerSnapshot> workers;    ///< One entry per worker.
+    std::size_t highWater = 0;              ///< Most jobs queued at once.
+    std::size_t contentions = 0;            ///< Job list locks which had to wait.
+    std::chrono::nanoseconds lockWait{0};   ///< Time the contended job list locks waited.
+    std::size_t timeouts = 0;               ///< Submissions dropped after the job time out.
+    std::size_t rejections = 0;             ///< Submissions to a stopped service.
+    std::size_t shed = 0;                   ///< Jobs dropped after their deadline.
+    std::size_t overflows = 0;              ///< Jobs refused or evicted by the overflow policy.
+};
+
+} // namespace NSA
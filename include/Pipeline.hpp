@@ -0,0 +1,327 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Credits.hpp"
+#include "Future.hpp"
+#include "Job.hpp"
+#include "Service.hpp"
+
+namespace NSA
+{
+
+/// How a pipeline stage may be run, see Pipeline::stage.
+enum class Fusion
+{
+	Queue,  ///< Always queue the stage on its own service.
+	Inline  ///< Run the stage on the worker of the stage before, if its service has an idle worker.
+};
+
+/**
+ * @brief A stage of a Pipeline.
+ */
+template <class Function>
+struct PipelineStage
+{
+	Service *service;              ///< The workers of the stage.
+	Function function;             ///< Turns the input into the output of the stage.
+	Fusion fusion;                 ///< May run inline.
+	std::unique_ptr<Credits<>> room; ///< Free room of the stage, unset if unbounded.
+};
+
+/**
+ * @brief Counters of the hand offs between the stages of a Pipeline.
+ */
+struct PipelineHops
+{
+	std::atomic<std::size_t> fused{0};  ///< Stages run on the worker before.
+	std::atomic<std::size_t> queued{0}; ///< Stages queued on their service.
+};
+
+/**
+ * @brief Value type between the stages, after all Functions ran on a Value.
+ */
+template <class Value, class... Functions>
+struct PipelineResult
+{
+	typedef Value type;
+};
+
+template <class Value, class Function, class... Rest>
+struct PipelineResult<Value, Function, Rest...>
+{
+	typedef typename PipelineResult<typename std::invoke_result<Function &, Value>::type, Rest...>::type type;
+};
+
+/**
+ * @brief A typed chain of services.
+ * @details Each stage runs a function on the workers of a service and
+ * hands its result to the next stage, the result of the last stage
+ * completes the future returned by push. Unlike services which call
+ * each other, a pipeline only creates a single promise per element,
+ * no matter how many stages it passes.
+ *
+ * A stage declared Fusion::Inline is cheap enough to run right on the
+ * worker which finished the stage before. The pipeline does so as long
+ * as the service of that stage has no queued jobs, an idle worker whose
+ * place it takes meanwhile, see Service::borrowWorker, and the stage has
+ * room. So a calm pipeline runs the whole chain on one thread without
+ * any queue hand off, and a stage never runs more often at once than
+ * its service has workers. Otherwise the stage is queued on its service as
+ * usual, behind the jobs already waiting there. The first stage is
+ * always queued, so push never runs a stage on the calling thread.
+ *
+ * A stage with a capacity holds at most that many elements at once,
+ * queued or running. A stage which finds the next one full waits for
+ * room, so a slow stage holds back the ones before it. It waits up to
+ * the job time out of the service of the full stage, then the element
+ * fails with Overloaded. Stages with a
+ * capacity should run on services of their own, a worker waiting for
+ * room of its own service waits forever.
+ *
+ * Pipelines are built in place from the input type, and must not be
+ * moved once an element was pushed:
+ *
+ *     auto line = NSA::Pipeline<Customer>()
+ *         .stage(standing, enterShop)
+ *         .stage(sofa, sitOnSofa, 3, NSA::Fusion::Inline)
+ *         .stage(barber, cutHair, 1);
+ *
+ * @tparam In The input type of the first stage.
+ * @tparam Functions The functions of the stages.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class In, class... Functions>
+class Pipeline
+{
+public:
+	/// Output type of the last stage.
+	typedef typename PipelineResult<In, Functions...>::type Out;
+
+	Pipeline() : stages(), hops(new PipelineHops())
+	{}
+
+	Pipeline(Pipeline &&) = default;
+	Pipeline(const Pipeline &) = delete;
+	Pipeline &operator=(const Pipeline &) = delete;
+
+	/**
+	 * @brief Appends a stage.
+	 * @param service The service whose workers run the stage.
+	 * @param function Turns the output of the last stage into the input
+	 * of the next one. Only the function of the last stage may return
+	 * void.
+	 * @param capacity The most elements in the stage at once. Zero
+	 * means unbounded.
+	 * @param fusion If the stage may run on the worker of the stage
+	 * before.
+	 * @return The pipeline with the new stage. This one is left empty.
+	 */
+	template <class Function>
+	Pipeline<In, Functions..., typename std::decay<Function>::type> stage(Service &service, Function &&function,
+		const std::size_t capacity = 0, const Fusion fusion = Fusion::Queue) &&
+	{
+		typedef typename std::decay<Function>::type Stage;
+
+		static_assert(!std::is_void<Out>::value, "Only the last stage may return void");
+		static_assert(std::is_invocable<Stage &, Out>::value, "The stage does not take the output of the last one");
+
+		PipelineStage<Stage> next{&service, std::forward<Function>(function), fusion,
+			std::unique_ptr<Credits<>>(capacity ? new Credits<>(capacity) : nullptr)};
+
+		return Pipeline<In, Functions..., Stage>(std::tuple_cat(std::move(stages),
+			std::make_tuple(std::move(next))), std::move(hops));
+	}
+
+	/**
+	 * @brief Queues an element on the first stage.
+	 * @details Waits while the first stage is full.
+	 * @return The future of the output of the last stage. It receives
+	 * the exception of a failing stage, or Overloaded if a service did
+	 * not take the element.
+	 */
+	Future<Out> push(In value)
+	{
+		static_assert(sizeof...(Functions) > 0, "A pipeline needs a stage");
+
+		Promise<Out> promise;
+		Future<Out> future = promise->get_future();
+
+		forward<0>(std::move(value), promise);
+
+		return future;
+	}
+
+	/**
+	 * @brief Getter for the amount of stages which ran inline.
+	 */
+	std::size_t fusedHops() const
+	{
+		return hops->fused.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Getter for the amount of stages which were queued.
+	 */
+	std::size_t queuedHops() const
+	{
+		return hops->queued.load(std::memory_order_relaxed);
+	}
+
+private:
+	static constexpr std::size_t Stages = sizeof...(Functions);
+
+	Pipeline(std::tuple<PipelineStage<Functions>...> &&stages, std::unique_ptr<PipelineHops> &&hops) :
+		stages(std::move(stages)), hops(std::move(hops))
+	{}
+
+	/**
+	 * @brief The queued job of a stage.
+	 * @details Fails the element if the service cancels the job.
+	 */
+	template <std::size_t I, class Value>
+	struct Hop
+	{
+		Pipeline *pipeline;
+		Value value;
+		Promise<Out> promise;
+
+		void operator()()
+		{
+			pipeline->template run<I>(std::move(value), promise, false);
+		}
+
+		void cancel(std::exception_ptr error)
+		{
+			pipeline->template leave<I>();
+			promise->set_exception(error);
+		}
+	};
+
+	/**
+	 * @brief Hands an element to stage I, or completes the future after
+	 * the last stage.
+	 */
+	template <std::size_t I, class Value>
+	void forward(Value &&value, Promise<Out> &promise)
+	{
+		if constexpr (I == Stages)
+		{
+			promise->set_value(std::forward<Value>(value));
+		}
+		else
+		{
+			PipelineStage<typename std::tuple_element<I, std::tuple<Functions...>>::type> &stage =
+				std::get<I>(stages);
+
+			const bool room = !stage.room || stage.room->tryAcquire(1) == 1;
+
+			if (I > 0 && room && stage.fusion == Fusion::Inline && stage.service->borrowWorker())
+			{
+				hops->fused.fetch_add(1, std::memory_order_relaxed);
+				run<I>(std::forward<Value>(value), promise, true);
+				return;
+			}
+
+			typedef Hop<I, typename std::decay<Value>::type> Queued;
+
+			// A stalled stage must not hold the worker before it forever.
+			const bool admitted = room || stage.room->acquire(1, []{return false;},
+				std::chrono::steady_clock::now() + stage.service->jobTimeOut()) == 1;
+
+			if (!admitted || !stage.service->post(Job(Queued{this, std::forward<Value>(value), promise})))
+			{
+				if (admitted)
+					leave<I>();
+
+				promise->set_exception(std::make_exception_ptr(
+					Overloaded("Pipeline stage " + std::to_string(I))));
+				return;
+			}
+
+			hops->queued.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * @brief Runs stage I and forwards its output.
+	 * @param fused If the stage runs on a borrowed worker of its service.
+	 */
+	template <std::size_t I, class Value>
+	void run(Value &&value, Promise<Out> &promise, const bool fused)
+	{
+		typedef typename std::tuple_element<I, std::tuple<Functions...>>::type Function;
+		typedef typename std::invoke_result<Function &, Value>::type Result;
+
+		Function &function = std::get<I>(stages).function;
+
+		if constexpr (std::is_void<Result>::value)
+		{
+			try
+			{
+				function(std::forward<Value>(value));
+			}
+			catch (...)
+			{
+				leave<I>(fused);
+				promise->set_exception(std::current_exception());
+				return;
+			}
+
+			leave<I>(fused);
+			promise->set_value();
+		}
+		else
+		{
+			std::optional<Result> result;
+
+			try
+			{
+				result.emplace(function(std::forward<Value>(value)));
+			}
+			catch (...)
+			{
+				leave<I>(fused);
+				promise->set_exception(std::current_exception());
+				return;
+			}
+
+			// The room and the borrowed worker are handed back first, so
+			// a worker waiting for the next stage holds neither of this one.
+			leave<I>(fused);
+			forward<I + 1>(std::move(*result), promise);
+		}
+	}
+
+	/**
+	 * @brief Hands back the room an element took in stage I, and the
+	 * worker place an inline run borrowed.
+	 */
+	template <std::size_t I>
+	void leave(const bool fused = false)
+	{
+		if (std::get<I>(stages).room)
+			std::get<I>(stages).room->release(1);
+
+		if (fused)
+			std::get<I>(stages).service->returnWorker();
+	}
+
+	template <class, class...> friend class Pipeline;
+
+	std::tuple<PipelineStage<Functions>...> stages;
+	std::unique_ptr<PipelineHops> hops;  ///< Hand offs so far.
+};
+
+} // namespace NSA
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace NSA
+{
+
+/*!
+ * @brief Where the workers of a service run and keep their memory.
+ * @details By default a worker runs on any CPU. A placement pins the
+ *          workers either to an explicit list of CPUs, one CPU per
+ *          worker in turn, or to all CPUs of a NUMA node. A node
+ *          placement also names the node the service allocates its job
+ *          list from, so the workers and the storage they share stay
+ *          on one socket.
+ *          The topology is read from sysfs. On machines without NUMA,
+ *          or on other systems than Linux, every CPU belongs to node
+ *          zero and pinning to a node which does not exist does
+ *          nothing.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+class Placement
+{
+public:
+    /**
+     * @brief Creates a placement which leaves the workers unpinned.
+     */
+    Placement() : memory(-1) {}
+
+    /**
+     * @brief Pins worker i to cpus[i % cpus.size()].
+     */
+    static Placement onCpus(const std::vector<int> &cpus)
+    {
+        Placement placement;
+        placement.cpus = cpus;
+        placement.spread = true;
+
+        return placement;
+    }
+
+    /**
+     * @brief Pins every worker to all CPUs of a node, and prefers the
+     *        memory of that node.
+     */
+    static Placement onNode(const int node)
+    {
+        Placement placement;
+        placement.cpus = nodeCpus(node);
+        placement.memory = placement.cpus.empty() ? -1 : node;
+
+        return placement;
+    }
+
+    /**
+     * @brief Check to see if the workers get pinned at all.
+     */
+    bool pinned() const
+    {
+        return !cpus.empty();
+    }
+
+    /**
+     * @brief Getter for the preferred memory node. Negative for none.
+     */
+    int node() const
+    {
+        return memory;
+    }
+
+    /**
+     * @brief Pins the calling thread.
+     * @param worker The index of the worker running on the thread.
+     * @return False if the thread could not be pinned.
+     */
+    bool pin(const std::size_t worker) const
+    {
+        if (cpus.empty())
+            return true;
+
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+
+        if (spread)
+            CPU_SET(cpus[worker % cpus.size()], &set);
+        else
+            for (const int cpu : cpus)
+                CPU_SET(cpu, &set);
+
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)worker;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Getter for the amount of NUMA nodes. At least one.
+     * @details Counts up to the highest online node. Nodes in between
+     *          may be offline or hold memory only, their CPU list is
+     *          empty then.
+     */
+    static std::size_t nodes()
+    {
+#if defined(__linux__)
+        const std::vector<int> online = readList("/sys/devices/system/node/online");
+
+        if (!online.empty())
+            return static_cast<std::size_t>(online.back()) + 1;
+#endif
+        return 1;
+    }
+
+    /**
+     * @brief Getter for the CPUs of a NUMA node.
+     * @details Without NUMA information, node zero holds every CPU.
+     * @return The CPUs, empty if the node does not exist.
+     */
+    static std::vector<int> nodeCpus(const int node)
+    {
+        std::vector<int> result;
+
+        if (node < 0)
+            return result;
+
+#if defined(__linux__)
+        const std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+        bool found = false;
+        result = readList(path, &found);
+
+        if (found)
+            return result;
+#endif
+
+        if (node == 0)
+        {
+            const int count = static_cast<int>(std::thread::hardware_concurrency());
+
+            for (int cpu = 0; cpu < count; cpu++)
+                result.push_back(cpu);
+        }
+
+        return result;
+    }
+
+private:
+    /**
+     * @brief Reads a sysfs list like "0-3,8-11".
+     * @param found Set if the file exists, if given.
+     */
+    static std::vector<int> readList(const std::string &path, bool *found = nullptr)
+    {
+        std::vector<int> result;
+        FILE *file = fopen(path.c_str(), "r");
+
+        if (found)
+            *found = file != nullptr;
+
+        if (!file)
+            return result;
+
+        int first = 0;
+
+        while (fscanf(file, "%d", &first) == 1)
+        {
+            int last = first;
+            const int separator = fgetc(file);
+
+            if (separator == '-' && fscanf(file, "%d", &last) == 1)
+                fgetc(file);
+
+            for (int value = first; value <= last; value++)
+                result.push_back(value);
+        }
+
+        fclose(file);
+        return result;
+    }
+
+    std::vector<int> cpus;  ///< CPUs to pin to. Empty for no pinning.
+    bool spread = false;    ///< One CPU per worker, instead of the whole set.
+    int memory;             ///< Preferred memory node, negative for none.
+};
+
+/*!
+ * @brief Prefers the memory of a NUMA node for the allocations of the
+ *        calling thread, as long as the scope lives.
+ * @details Only new pages are placed on the node. Memory the allocator
+ *          already holds is handed out as is. Does nothing for a
+ *          negative node, or if the kernel has no NUMA support. The
+ *          policy the thread had before comes back with the end of the
+ *          scope.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+class NodeMemoryScope
+{
+public:
+    explicit NodeMemoryScope(const int node) : active(false), previous(0), previousNodes()
+    {
+#if defined(__linux__)
+        if (node < 0 || node >= static_cast<int>(8 * sizeof(unsigned long)))
+            return;
+
+        if (syscall(SYS_get_mempolicy, &previous, previousNodes, 8 * sizeof(previousNodes), nullptr, 0) != 0)
+            return;
+
+        const unsigned long mask = 1UL << node;
+        active = syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, 8 * sizeof(mask)) == 0;
+#else
+        (void)node;
+#endif
+    }
+
+    ~NodeMemoryScope()
+    {
+#if defined(__linux__)
+        if (active)
+            syscall(SYS_set_mempolicy, previous, previousNodes, 8 * sizeof(previousNodes));
+#endif
+    }
+
+    NodeMemoryScope(const NodeMemoryScope &) = delete;
+    NodeMemoryScope &operator=(const NodeMemoryScope &) = delete;
+
+private:
+    bool active;                     ///< Set if the policy was changed.
+    int previous;                    ///< Policy before the scope, with its mode flags.
+    unsigned long previousNodes[16]; ///< Nodes of the policy before the scope.
+};
+
+} // namespace NSA
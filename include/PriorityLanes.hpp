@@ -0,0 +1,615 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "BlockingQueue.hpp"
+#include "WaitStrategy.hpp"
+
+namespace NSA
+{
+
+/// Priority levels of the jobs of a service.
+enum class Priority
+{
+    High,   ///< Latency sensitive requests.
+    Normal, ///< The default.
+    Low     ///< Bulk work, which may wait.
+};
+
+/*!
+ * @brief A set of blocking queues, one per priority level.
+ * @details Each level has a lane of its own with its own top, so a flood
+ *          of low priority jobs only blocks the producers of that lane.
+ *          Consumers pick lanes by weighted round robin: within a round
+ *          a lane hands out at most its weight in elements, after which
+ *          the lower lanes get their turn. An idle lane passes its turn
+ *          on, so the high lane gets everything as long as the others
+ *          are empty, but a busy high lane cannot starve the low one.
+ *          Picking a lane only looks at the fixed amount of lanes, so it
+ *          takes constant time.
+ *          Each consumer keeps its own Cursor with the remaining credits
+ *          of the current round.
+ *
+ *          Lanes with many producers can be split into shards. Each
+ *          shard is a queue of its own, a producer pushes into the shard
+ *          of its thread and consumers drain the shards of a lane round
+ *          robin. So producers on different shards never share a lock.
+ *          A consumer stays on a shard until it comes up empty, or for
+ *          at most ShardStreak pops, so it rarely looks into empty
+ *          shards.
+ *          The top still applies to the whole lane: a sharded lane
+ *          counts its elements in a single atomic, which producers
+ *          reserve before they push. The same counter makes size()
+ *          cheap. Elements of one producer keep their order, elements
+ *          of different producers only roughly.
+ *
+ * @tparam T The element type.
+ * @tparam Wait The wait strategy, see WaitStrategy.hpp.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class T, class Wait = BlockingWait>
+class PriorityLanes
+{
+public:
+    /// Amount of priority levels.
+    static constexpr std::size_t Lanes = 3;
+
+    /// Round robin state of a single consumer.
+    struct Cursor
+    {
+        std::size_t credits[Lanes] = {0, 0, 0};  ///< Turns left in this round.
+        std::size_t shard[Lanes] = {0, 0, 0};    ///< Shard the next pop of a lane starts at.
+        std::size_t streak[Lanes] = {0, 0, 0};   ///< Pops in a row from that shard.
+    };
+
+    /**
+     * @param maxItems The top of every lane. Zero means unbounded.
+     * @param backend The storage backend of every lane.
+     */
+    PriorityLanes(const std::size_t maxItems = 0, const QueueBackend backend = QueueBackend::Locked) :
+        requested(backend),
+        shards(1),
+        closed(false)
+    {
+        for (std::size_t i = 0; i < Lanes; i++)
+        {
+            limits[i] = maxItems;
+            weights[i] = DefaultWeights[i];
+            queued[i] = 0;
+            build(i);
+        }
+    }
+
+    /**
+     * @brief Replaces the top of a single lane.
+     * @details Drops the elements of that lane, so it has to be called
+     *          before the lanes are used.
+     */
+    void limit(const Priority lane, const std::size_t maxItems)
+    {
+        limits[index(lane)] = maxItems;
+        build(index(lane));
+    }
+
+    /**
+     * @brief Splits every lane into shards.
+     * @details The Spsc backend has a single producer, so it keeps a
+     *          single shard. With the Ordered backend, each shard pops
+     *          by its own order. Drops the elements, so it has to be
+     *          called before the lanes are used.
+     * @param count The amount of shards per lane. At least one.
+     */
+    void shard(const std::size_t count)
+    {
+        shards = count < 1 || lanes[0][0]->backend() == QueueBackend::Spsc ? 1 : count;
+
+        for (std::size_t i = 0; i < Lanes; i++)
+            build(i);
+    }
+
+    /**
+     * @brief Allocates the storage of every lane anew.
+     * @details Keeps the top, the backend and the shards of each lane.
+     *          Used to move the storage to the memory of another node.
+     *          Drops the elements, so it has to be called before the
+     *          lanes are used.
+     */
+    void relocate()
+    {
+        for (std::size_t i = 0; i < Lanes; i++)
+            build(i);
+    }
+
+    /**
+     * @brief Sets the share of a lane within a round robin round.
+     * @details Has to be called before the lanes are used.
+     * @param weight Elements per round. At least one.
+     */
+    void weight(const Priority lane, const std::size_t weight)
+    {
+        weights[index(lane)] = weight < 1 ? 1 : weight;
+    }
+
+    /**
+     * @brief Blocking and waiting push into a lane.
+     * @details Blocks like BlockingQueue::push while that lane is full.
+     *          The other lanes are not affected.
+     * @return True on success. False if a timeout happend.
+     */
+    bool push(const Priority lane, T &&src, const std::chrono::milliseconds timeOut)
+    {
+        const std::size_t i = index(lane);
+
+        if (shards == 1)
+        {
+            if (!lanes[i][0]->push(std::move(src), timeOut))
+                return false;
+        }
+        else if (!reserve(i, timeOut) || !commit(i, src))
+            return false;
+
+        notEmpty.notifyOne();
+        return true;
+    }
+
+    /**
+     * @brief Non blocking push into a lane.
+     * @return True on success. False if that lane is full or closed.
+     */
+    bool tryPush(const Priority lane, T &&src)
+    {
+        const std::size_t i = index(lane);
+
+        if (shards == 1)
+        {
+            if (!lanes[i][0]->tryPush(std::move(src)))
+                return false;
+        }
+        else if (!tryReserve(i) || !commit(i, src))
+            return false;
+
+        notEmpty.notifyOne();
+        return true;
+    }
+
+    /**
+     * @brief Non blocking push into a lane, which makes room if needed.
+     * @details See BlockingQueue::forcePush. Only the first element of
+     *          the same lane is evicted. A sharded lane evicts the first
+     *          element of the first shard which has one, starting at the
+     *          shard of the caller. Callers have to check evicted even
+     *          on Refused, see forceShard.
+     */
+    PushResult forcePush(const Priority lane, T &&src, T *evicted)
+    {
+        const std::size_t i = index(lane);
+        const PushResult result = shards == 1 ? lanes[i][0]->forcePush(std::move(src), evicted)
+            : forceShard(i, src, evicted);
+
+        if (result != PushResult::Refused)
+            notEmpty.notifyOne();
+
+        return result;
+    }
+
+    /**
+     * @brief Blocking and waiting bulk pop from the lanes.
+     * @details Takes up to maxCount elements, but only from a single
+     *          lane, the next one in the round robin of the cursor.
+     * @return The amount of popped elements. Zero if the lanes are
+     *         closed and drained.
+     */
+    template <class OutputIt>
+    std::size_t popBulk(Cursor &cursor, OutputIt out, const std::size_t maxCount)
+    {
+        std::size_t count = take(cursor, out, maxCount);
+
+        if (count == 0)
+        {
+            notEmpty.wait([this, &cursor, &out, maxCount, &count]
+            {
+                return (count = take(cursor, out, maxCount)) > 0 || closed;
+            });
+
+            // Closing races with the last producers, so look once more.
+            if (count == 0)
+                count = take(cursor, out, maxCount);
+        }
+
+        return count;
+    }
+
+    /**
+     * @brief Bulk pop from the lanes, which waits up to timeOut.
+     * @details Same as popBulk, but gives up if no element arrives in
+     *          time.
+     * @return The amount of popped elements. Zero on a timeout, or if
+     *         the lanes are closed and drained.
+     */
+    template <class OutputIt>
+    std::size_t popBulkFor(Cursor &cursor, OutputIt out, const std::size_t maxCount,
+        const std::chrono::milliseconds timeOut)
+    {
+        std::size_t count = take(cursor, out, maxCount);
+
+        if (count == 0)
+        {
+            notEmpty.waitUntil([this, &cursor, &out, maxCount, &count]
+            {
+                return (count = take(cursor, out, maxCount)) > 0 || closed;
+            }, std::chrono::steady_clock::now() + timeOut);
+
+            if (count == 0)
+                count = take(cursor, out, maxCount);
+        }
+
+        return count;
+    }
+
+    /**
+     * @brief Non blocking bulk pop from the lanes.
+     * @details Same as popBulk, but returns right away if every lane
+     *          is empty.
+     */
+    template <class OutputIt>
+    std::size_t tryPopBulk(Cursor &cursor, OutputIt out, const std::size_t maxCount)
+    {
+        return take(cursor, out, maxCount);
+    }
+
+    /**
+     * @brief Non blocking pop of a single element.
+     */
+    bool tryPop(Cursor &cursor, T *dst)
+    {
+        return take(cursor, dst, 1) == 1;
+    }
+
+    /**
+     * @brief Closes every lane for further input.
+     */
+    void close()
+    {
+        for (std::size_t i = 0; i < Lanes; i++)
+            for (const std::unique_ptr<BlockingQueue<T, Wait>> &queue : lanes[i])
+                queue->close();
+
+        closed = true;
+        notEmpty.notifyAll();
+
+        for (std::size_t i = 0; i < Lanes; i++)
+            notFull[i].notifyAll();
+    }
+
+    /**
+     * @brief Getter for the amount of elements in all lanes.
+     */
+    std::size_t size() const
+    {
+        std::size_t count = 0;
+
+        for (std::size_t i = 0; i < Lanes; i++)
+            count += shards == 1 ? lanes[i][0]->size() : queued[i].load(std::memory_order_relaxed);
+
+        return count;
+    }
+
+    /**
+     * @brief Check to see if the lanes were closed.
+     */
+    bool isClosed() const
+    {
+        return closed;
+    }
+
+    bool empty() const
+    {
+        if (shards > 1)
+            return size() == 0;
+
+        for (std::size_t i = 0; i < Lanes; i++)
+            if (!lanes[i][0]->empty())
+                return false;
+
+        return true;
+    }
+
+    /**
+     * @brief Getter for a single lane, or its first shard.
+     */
+    const BlockingQueue<T, Wait> &lane(const Priority lane) const
+    {
+        return *lanes[index(lane)][0];
+    }
+
+    /**
+     * @brief Getter for the top of a lane.
+     */
+    std::size_t max(const Priority lane) const
+    {
+        return lanes[index(lane)][0]->max();
+    }
+
+    /**
+     * @brief Getter for the most elements queued at once in a lane.
+     * @details For a sharded lane, the sum of the peaks of its shards,
+     *          which is an upper bound.
+     */
+    std::size_t highWater(const Priority lane) const
+    {
+        std::size_t peak = 0;
+
+        for (const std::unique_ptr<BlockingQueue<T, Wait>> &queue : lanes[index(lane)])
+            peak += queue->highWater();
+
+        return shards == 1 ? peak : std::min(peak, max(lane));
+    }
+
+    /**
+     * @brief Getter for the amount of contended locks of a lane.
+     */
+    std::size_t contentions(const Priority lane) const
+    {
+        std::size_t count = 0;
+
+        for (const std::unique_ptr<BlockingQueue<T, Wait>> &queue : lanes[index(lane)])
+            count += queue->contentions();
+
+        return count;
+    }
+
+    /**
+     * @brief Getter for the time spent blocking on the locks of a lane.
+     */
+    std::chrono::nanoseconds lockWait(const Priority lane) const
+    {
+        std::chrono::nanoseconds wait(0);
+
+        for (const std::unique_ptr<BlockingQueue<T, Wait>> &queue : lanes[index(lane)])
+            wait += queue->lockWait();
+
+        return wait;
+    }
+
+    /**
+     * @brief Getter for the backend of the lanes.
+     */
+    QueueBackend backend() const
+    {
+        return lanes[0][0]->backend();
+    }
+
+    /**
+     * @brief Getter for the amount of shards per lane.
+     */
+    std::size_t shardCount() const
+    {
+        return shards;
+    }
+
+private:
+    /// Elements per round robin round of the High, Normal and Low lane.
+    static constexpr std::size_t DefaultWeights[Lanes] = {8, 2, 1};
+
+    /// Pops in a row from one shard, before a consumer moves on.
+    static constexpr std::size_t ShardStreak = 16;
+
+    static std::size_t index(const Priority lane)
+    {
+        return static_cast<std::size_t>(lane);
+    }
+
+    /**
+     * @brief Process wide index of the calling thread, which picks its
+     *        shard.
+     */
+    static std::size_t threadIndex()
+    {
+        static std::atomic<std::size_t> threads(0);
+        thread_local const std::size_t index = threads.fetch_add(1, std::memory_order_relaxed);
+
+        return index;
+    }
+
+    /**
+     * @brief Creates the shards of a lane anew.
+     * @details Every shard gets the top of the whole lane, so a shard
+     *          never fills up before the lane does.
+     */
+    void build(const std::size_t lane)
+    {
+        lanes[lane].clear();
+
+        for (std::size_t i = 0; i < shards; i++)
+            lanes[lane].emplace_back(new BlockingQueue<T, Wait>(limits[lane], requested));
+
+        queued[lane] = 0;
+    }
+
+    /**
+     * @brief Takes room for one element of a sharded lane, if there is.
+     */
+    bool tryReserve(const std::size_t lane)
+    {
+        const std::size_t maxItems = lanes[lane][0]->max();
+        std::size_t count = queued[lane].load(std::memory_order_relaxed);
+
+        do
+        {
+            if (count >= maxItems || closed)
+                return false;
+        }
+        while (!queued[lane].compare_exchange_weak(count, count + 1, std::memory_order_relaxed));
+
+        return true;
+    }
+
+    /**
+     * @brief Takes room for one element of a sharded lane, and waits up
+     *        to timeOut for it.
+     */
+    bool reserve(const std::size_t lane, const std::chrono::milliseconds timeOut)
+    {
+        if (tryReserve(lane))
+            return true;
+
+        bool reserved = false;
+
+        notFull[lane].waitUntil([this, lane, &reserved]{return (reserved = tryReserve(lane)) || closed;},
+            std::chrono::steady_clock::now() + timeOut);
+
+        return reserved;
+    }
+
+    /**
+     * @brief Hands back the room of popped or refused elements.
+     */
+    void unreserve(const std::size_t lane, const std::size_t count)
+    {
+        queued[lane].fetch_sub(count, std::memory_order_relaxed);
+
+        if (count == 1)
+            notFull[lane].notifyOne();
+        else
+            notFull[lane].notifyAll();
+    }
+
+    /**
+     * @brief Pushes an element with reserved room into the shard of the
+     *        calling thread.
+     * @return False if the lanes were closed meanwhile.
+     */
+    bool commit(const std::size_t lane, T &src)
+    {
+        if (lanes[lane][threadIndex() % shards]->tryPush(std::move(src)))
+            return true;
+
+        unreserve(lane, 1);
+        return false;
+    }
+
+    /**
+     * @brief forcePush of a sharded lane.
+     * @details The lock-free backends cannot evict, like a single
+     *          queue of them. The new element goes into the shard the
+     *          evicted one came from. If the lanes close in between, the
+     *          result is Refused, but evicted still holds the element.
+     */
+    PushResult forceShard(const std::size_t lane, T &src, T *evicted)
+    {
+        if (tryReserve(lane))
+            return commit(lane, src) ? PushResult::Pushed : PushResult::Refused;
+
+        if (closed || backend() == QueueBackend::Ring)
+            return PushResult::Refused;
+
+        // The room of the evicted element goes to the new one.
+        const std::size_t first = threadIndex() % shards;
+
+        for (std::size_t i = 0; i < shards; i++)
+        {
+            if (!lanes[lane][(first + i) % shards]->tryPop(evicted))
+                continue;
+
+            if (lanes[lane][(first + i) % shards]->tryPush(std::move(src)))
+                return PushResult::Evicted;
+
+            unreserve(lane, 1);
+            return PushResult::Refused;
+        }
+
+        return PushResult::Refused;
+    }
+
+    /**
+     * @brief Pops from the next lane of the round robin.
+     */
+    template <class OutputIt>
+    std::size_t take(Cursor &cursor, OutputIt &out, const std::size_t maxCount)
+    {
+        if (maxCount == 0)
+            return 0;
+
+        // The second pass starts a new round.
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (std::size_t i = 0; i < Lanes; i++)
+            {
+                if (cursor.credits[i] == 0)
+                    continue;
+
+                const std::size_t count = shards == 1
+                    ? lanes[i][0]->tryPopBulk(out, std::min(maxCount, cursor.credits[i]))
+                    : takeShards(cursor, i, out, std::min(maxCount, cursor.credits[i]));
+
+                if (count > 0)
+                {
+                    cursor.credits[i] -= count;
+                    return count;
+                }
+            }
+
+            for (std::size_t i = 0; i < Lanes; i++)
+                cursor.credits[i] = weights[i];
+        }
+
+        return 0;
+    }
+
+    /**
+     * @brief Pops from the shards of a lane, round robin.
+     */
+    template <class OutputIt>
+    std::size_t takeShards(Cursor &cursor, const std::size_t lane, OutputIt &out, const std::size_t maxCount)
+    {
+        // An empty lane costs a single load instead of a look into every shard.
+        if (queued[lane].load(std::memory_order_relaxed) == 0)
+            return 0;
+
+        for (std::size_t i = 0; i < shards; i++)
+        {
+            const std::size_t shard = cursor.shard[lane] % shards;
+            const std::size_t count = lanes[lane][shard]->tryPopBulk(out, maxCount);
+
+            if (count < maxCount || ++cursor.streak[lane] >= ShardStreak)
+            {
+                cursor.shard[lane]++;
+                cursor.streak[lane] = 0;
+            }
+
+            if (count > 0)
+            {
+                unreserve(lane, count);
+                return count;
+            }
+        }
+
+        return 0;
+    }
+
+    std::vector<std::unique_ptr<BlockingQueue<T, Wait>>> lanes[Lanes]; ///< Shards per lane.
+    std::size_t limits[Lanes];                  ///< Top per lane. Zero means unbounded.
+    std::size_t weights[Lanes];                 ///< Elements per round and lane.
+    const QueueBackend requested;               ///< Backend for replaced lanes.
+    std::size_t shards;                         ///< Queues per lane.
+    std::atomic<std::size_t> queued[Lanes];     ///< Elements per sharded lane, including reserved room.
+    std::atomic<bool> closed;                   ///< Set once every lane is closed.
+    Wait notEmpty;                              ///< Consumers waiting for any lane.
+    Wait notFull[Lanes];                        ///< Producers waiting for room in a sharded lane.
+};
+
+template <class T, class Wait>
+constexpr std::size_t PriorityLanes<T, Wait>::DefaultWeights[PriorityLanes<T, Wait>::Lanes];
+
+template <class T, class Wait>
+constexpr std::size_t PriorityLanes<T, Wait>::ShardStreak;
+
+} // namespace NSA
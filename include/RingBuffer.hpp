@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace NSA
+{
+
+/// Assumed size of a cache line. Used to keep hot atomics apart.
+constexpr std::size_t CacheLineSize = 64;
+
+/*!
+ * @brief Lock-free bounded multi producer multi consumer ring buffer.
+ * @details The ring is preallocated on construction and never allocates
+ *          afterwards. Every cell carries a sequence number which tells
+ *          producers and consumers whether the cell is free or filled
+ *          for their current lap around the ring. Producers and
+ *          consumers only contend on their own position counter, each
+ *          of which lives on a separate cache line.
+ *          The ring does not block. Both operations fail instantly if
+ *          the ring is full or empty. Blocking is left to the owner,
+ *          see BlockingQueue.
+ *          The capacity has to be at least two.
+ *          The cells are raw storage. An element is move constructed
+ *          into its cell on push and destroyed on pop, so T does not
+ *          have to be default constructible.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class T>
+class RingBuffer
+{
+public:
+    RingBuffer(const std::size_t capacity);
+    ~RingBuffer();
+
+    RingBuffer(const RingBuffer &) = delete;
+    RingBuffer &operator=(const RingBuffer &) = delete;
+
+    /**
+     * @brief Non blocking push.
+     * @details The src parameter is only moved from if the push
+     *          succeeds. On failure it is left untouched.
+     *
+     * @param src The item to move into the ring.
+     * @return True on success. False if the ring is full.
+     */
+    bool tryPush(T &&src);
+
+    /**
+     * @brief Non blocking pop.
+     * @param dst The storage of the popped element.
+     * @return True on success. False if the ring is empty.
+     */
+    bool tryPop(T &dst);
+
+    /**
+     * @brief Approximate amount of elements in the ring.
+     * @details The value is exact as long as no push or pop is in
+     *          flight.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Getter for the capacity of the ring.
+     */
+    std::size_t capacity() const;
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T &data()
+        {
+            return *reinterpret_cast<T *>(storage);
+        }
+    };
+
+    alignas(CacheLineSize) std::atomic<std::size_t> enqueuePos;
+    alignas(CacheLineSize) std::atomic<std::size_t> dequeuePos;
+    alignas(CacheLineSize) const std::size_t cellCount;
+    std::unique_ptr<Cell[]> cells;
+};
+
+/// Implementation.
+
+template <class T>
+RingBuffer<T>::RingBuffer(const std::size_t capacity) :
+    enqueuePos(0),
+    dequeuePos(0),
+    cellCount(capacity < 2 ? 2 : capacity),
+    cells(new Cell[cellCount])
+{
+    for (std::size_t i = 0; i < cellCount; i++)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <class T>
+RingBuffer<T>::~RingBuffer()
+{
+    const std::size_t tail = enqueuePos.load(std::memory_order_relaxed);
+
+    for (std::size_t pos = dequeuePos.load(std::memory_order_relaxed); pos != tail; pos++)
+        cells[pos % cellCount].data().~T();
+}
+
+template <class T>
+bool RingBuffer<T>::tryPush(T &&src)
+{
+    std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        Cell &cell = cells[pos % cellCount];
+        const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence - pos);
+
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                new (cell.storage) T(std::move(src));
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+            return false;
+        else
+            pos = enqueuePos.load(std::memory_order_relaxed);
+    }
+}
+
+template <class T>
+bool RingBuffer<T>::tryPop(T &dst)
+{
+    std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        Cell &cell = cells[pos % cellCount];
+        const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+
+        if (diff == 0)
+        {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                dst = std::move(cell.data());
+                cell.data().~T();
+                cell.sequence.store(pos + cellCount, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+            return false;
+        else
+            pos = dequeuePos.load(std::memory_order_relaxed);
+    }
+}
+
+template <class T>
+std::size_t RingBuffer<T>::size() const
+{
+    const std::size_t head = dequeuePos.load(std::memory_order_acquire);
+    const std::size_t tail = enqueuePos.load(std::memory_order_acquire);
+
+    return tail > head ? tail - head : 0;
+}
+
+template <class T>
+inline std::size_t RingBuffer<T>::capacity() const
+{
+    return cellCount;
+}
+
+} // namespace NSA
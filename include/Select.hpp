@@ -0,0 +1,144 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <initializer_list>
+#include <limits>
+#include <vector>
+
+#include "BlockingQueue.hpp"
+#include "WaitStrategy.hpp"
+
+namespace NSA
+{
+
+/*!
+ * @brief Waits on several blocking queues at once.
+ * @details Pops from whichever queue has an element first, so a single
+ *          thread can serve several inbound queues without polling them
+ *          in turn or spending a thread per queue.
+ *          The select registers a wait set of its own with every queue
+ *          for as long as it lives. A push or a close notifies that wait
+ *          set like the consumers of the queue, so a waiting select
+ *          parks until any of its queues changes.
+ *          The scan for an element starts at the queue after the one
+ *          which served the last pop. So a busy queue cannot starve the
+ *          others, every queue with elements gets its turn within one
+ *          round.
+ *          A select belongs to a single consumer thread. Other threads
+ *          may still pop from the queues directly.
+ *
+ * @tparam T The element type of all queues.
+ * @tparam Wait The wait strategy of all queues, see WaitStrategy.hpp.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class T, class Wait = BlockingWait>
+class Select
+{
+public:
+    /// Returned instead of a queue index if nothing was popped.
+    static constexpr std::size_t None = std::numeric_limits<std::size_t>::max();
+
+    /**
+     * @param queues The queues to wait on. They have to outlive the select.
+     */
+    Select(std::initializer_list<BlockingQueue<T, Wait> *> queues) :
+        Select(std::vector<BlockingQueue<T, Wait> *>(queues))
+    {}
+
+    explicit Select(const std::vector<BlockingQueue<T, Wait> *> &queues) :
+        queues(queues),
+        next(0)
+    {
+        for (BlockingQueue<T, Wait> *queue : this->queues)
+            queue->watch(&ready);
+    }
+
+    ~Select()
+    {
+        for (BlockingQueue<T, Wait> *queue : queues)
+            queue->unwatch(&ready);
+    }
+
+    Select(const Select &) = delete;
+    Select &operator=(const Select &) = delete;
+
+    /**
+     * @brief Blocking and waiting pop from the first ready queue.
+     * @param dst A pointer to the storage of the popped element.
+     * @return The index of the queue the element came from. None if
+     *         every queue was closed and is drained.
+     */
+    std::size_t pop(T *dst)
+    {
+        std::size_t index = tryPop(dst);
+
+        if (index == None)
+            ready.wait([this, dst, &index]{return (index = tryPop(dst)) != None || drained();});
+
+        return index;
+    }
+
+    /**
+     * @brief Pop from the first ready queue, which waits up to timeOut.
+     * @return The index of the queue the element came from. None on a
+     *         timeout, or if every queue was closed and is drained.
+     */
+    std::size_t pop(T *dst, const std::chrono::milliseconds timeOut)
+    {
+        std::size_t index = tryPop(dst);
+
+        if (index == None)
+            ready.waitUntil([this, dst, &index]{return (index = tryPop(dst)) != None || drained();},
+                std::chrono::steady_clock::now() + timeOut);
+
+        return index;
+    }
+
+    /**
+     * @brief Non blocking pop from the first ready queue.
+     * @return The index of the queue the element came from. None if
+     *         every queue is empty.
+     */
+    std::size_t tryPop(T *dst)
+    {
+        const std::size_t count = queues.size();
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const std::size_t index = (next + i) % count;
+
+            if (queues[index]->tryPop(dst))
+            {
+                next = index + 1;
+                return index;
+            }
+        }
+
+        return None;
+    }
+
+    /**
+     * @brief Check to see if every queue was closed and is drained.
+     */
+    bool drained() const
+    {
+        for (const BlockingQueue<T, Wait> *queue : queues)
+            if (!queue->isClosed() || !queue->empty())
+                return false;
+
+        return true;
+    }
+
+private:
+    const std::vector<BlockingQueue<T, Wait> *> queues;
+    std::size_t next;   ///< Queue the next scan starts at.
+    Wait ready;         ///< The select waiting for any queue.
+};
+
+template <class T, class Wait>
+constexpr std::size_t Select<T, Wait>::None;
+
+} // namespace NSA
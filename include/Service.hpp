@@ -1,14 +1,86 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
 #include <thread>
 #include <future>
+#include <vector>
 
-#include <NSA/BlockingQueue.hpp>
+#include "BlockingQueue.hpp"
+#include "Credits.hpp"
+#include "Executor.hpp"
+#include "Future.hpp"
+#include "Job.hpp"
+#include "Metrics.hpp"
+#include "Placement.hpp"
+#include "PriorityLanes.hpp"
+#include "SlabPool.hpp"
+#include "Trace.hpp"
+#include "WorkStealingDeque.hpp"
 
 namespace NSA
 {
 
+/// Ways the workers of a service share the jobs.
+enum class Scheduling
+{
+	SharedQueue,  ///< Every worker pops from the job list.
+	WorkStealing  ///< Every worker owns a deque and steals when idle.
+};
+
+/// What a submission does if its lane of the job list is full.
+enum class Overflow
+{
+	Block,      ///< Wait for room up to the job time out.
+	Reject,     ///< Fail the new job right away.
+	DropOldest  ///< Fail the job of the lane which was queued first.
+};
+
+/// Bounds and triggers of an elastic service, see Service::detach.
+struct Elasticity
+{
+	std::size_t minWorkers = 1;  ///< Workers kept at all times.
+	std::size_t maxWorkers = 4;  ///< Workers at peak load.
+	std::size_t queueDepth = 16; ///< Queued jobs which count as pressure.
+	std::chrono::microseconds queueWait = std::chrono::milliseconds(1); ///< Job wait which counts as pressure.
+	std::chrono::milliseconds sustain = std::chrono::milliseconds(20);  ///< Pressure before a worker is added.
+	std::chrono::milliseconds coolDown = std::chrono::seconds(1);       ///< Idle time before a worker retires.
+};
+
+/**
+ * @brief Error of a job which was dropped, because its deadline passed
+ * before a worker got to it.
+ */
+class DeadlineExceeded : public std::runtime_error
+{
+public:
+	explicit DeadlineExceeded(const std::string &service) :
+		std::runtime_error(service + ": Job missed its deadline")
+	{}
+};
+
+/**
+ * @brief Error of a job which was refused or evicted, because the job
+ * list of its service was full.
+ */
+class Overloaded : public std::runtime_error
+{
+public:
+	explicit Overloaded(const std::string &service) :
+		std::runtime_error(service + ": Job list is full")
+	{}
+};
+
 /**
  * @brief Abstract base class of a service
  * @details A service is defined by a promise and a future. The 
@@ -16,58 +88,233 @@ namespace NSA
  * client can call upon the future to get the completed job.
  * 
  * Each service has a job list. This list is a basic queue
- * that will be worked in FIFO order.
+ * that will be worked in FIFO order. The job list has a lane per
+ * Priority. Jobs of the same priority keep their FIFO order, the
+ * lanes share the workers by weighted round robin.
+ * 
+ * A job may carry a deadline. A worker which pops a job after its
+ * deadline drops it instead of running it, and its future receives a
+ * DeadlineExceeded error. With the Ordered backend, the jobs of a lane
+ * run earliest deadline first. Jobs without a deadline come last.
+ * 
+ * Services which forward their jobs to another service can be linked
+ * to it. The room in the job list downstream is then handed out as
+ * credits, and the upstream workers only pop a job once they hold a
+ * credit to forward it.
  * 
  */
 
 class Service
 {
 public:
-	template <class T> using Promise = std::shared_ptr<std::promise<T>>;
-	template <class T> using Future  = std::shared_ptr<std::future<T>>;
+	template <class T> using Promise = NSA::Promise<T>;
+	template <class T> using Future  = NSA::Future<T>;
+
+	/// Point in time after which a queued job is dropped.
+	typedef std::chrono::steady_clock::time_point Deadline;
 
 	/**
 	 * @brief Default constructor creates a deactivated service.
 	 * @details Services can be started and stipped via the
 	 * detach and join functions.
 	 * @param name Each service should have name.
+	 * @param jobLimit The maximum of queued jobs per priority lane. Zero
+	 * means unlimited.
+	 * @param backend The storage backend of the job list. The Ring
+	 * backend avoids locks for services with many producers. The Spsc
+	 * backend is meant for a service with a single worker, which is fed
+	 * by a single upstream thread, like a hop of a pipeline. The
+	 * Ordered backend runs the jobs of each lane by earliest deadline.
 	 */
-	Service(const std::string name, const std::size_t jobLimit = 0) : running(false), name(name),
-		jobCount(0), jobList(jobLimit)
-	{}
+	Service(const std::string name, const std::size_t jobLimit = 0,
+		const QueueBackend backend = QueueBackend::Locked) : name(name),
+		jobList(jobLimit, backend), jobCount(0), running(false), activeWorkers(0), timeOut(30),
+		overflow(Overflow::Block), batchSize(1),
+		scheduling(Scheduling::SharedQueue), pendingJobs(0), idleWorkers(0), busyWorkers(0),
+		executor(nullptr), concurrency(0), activeDrains(0), downstream(nullptr),
+		elastic(false), waitPeak(0)
+#if NSA_METRICS_ENABLED
+		, timeouts(0), rejections(0), shed(0), overflows(0)
+#endif
+	{
+		for (StatePool &slot : statePools)
+		{
+			slot.type.store(nullptr, std::memory_order_relaxed);
+			slot.pool.store(nullptr, std::memory_order_relaxed);
+		}
+
+#if NSA_TRACING_ENABLED
+		traceLabel = Trace::label(name);
+#endif
+	}
+
+	/**
+	 * @brief Hands the promise pools over to the pending futures.
+	 * @details A pool lives on until the last future allocated from it
+	 * is gone.
+	 */
+	~Service()
+	{
+		for (StatePool &slot : statePools)
+			if (SlabPool *owned = slot.pool.load(std::memory_order_acquire))
+				owned->release();
+	}
 
 	/**
 	 * @brief Start a service and detach the process from the
 	 * current thread.
 	 * @details Sets the running member variable to true and opens
 	 * the queue for more job input.
+	 *
+	 * With work stealing, each worker gets a deque of its own. Jobs
+	 * which a worker submits to its own service go to its deque, jobs
+	 * from any other thread go through the job list, which acts as the
+	 * injection queue. An idle worker first checks its deque, then the
+	 * job list, and then steals the oldest job of another worker.
+	 *
+	 * A placement pins the workers to CPUs or a NUMA node. With a node,
+	 * the job list is allocated anew from the memory of that node, and
+	 * the workers prefer it for their own allocations.
+	 * @param workers The amount of worker threads.
+	 * @param scheduling How the workers share the jobs.
+	 * @param placement Where the workers run.
 	 */
-	void detach(const std::size_t workers = 1)
+	void detach(const std::size_t workers = 1, const Scheduling scheduling = Scheduling::SharedQueue,
+		const Placement &placement = Placement())
 	{
+		assert((jobList.backend() != QueueBackend::Spsc || workers == 1)
+			&& "A Spsc job list supports a single worker only");
+
+		place(placement);
+		this->scheduling = scheduling;
+		resetMetrics(workers);
+		elastic = false;
+		activeWorkers = workers;
 		running = true;
+
+		if (scheduling == Scheduling::WorkStealing)
+		{
+			NodeMemoryScope memory(placement.node());
+
+			for (std::size_t i = 0; i < workers; i++)
+				localJobs.emplace_back(new WorkStealingDeque<Task>());
+
+			for (std::size_t i = 0; i < workers; i++)
+				workThreads.push_back(std::thread(&Service::stealWork, this, i));
+
+			return;
+		}
+
 		for (std::size_t i = 0; i < workers; i++)
-			workThreads.push_back(std::thread(&Service::work, this));	
+			workThreads.push_back(std::thread(&Service::work, this, i));
+	}
+
+	/**
+	 * @brief Start a service with a varying amount of workers.
+	 * @details Starts minWorkers workers on the shared queue, plus a
+	 * scaler thread which samples the job list. While the queued jobs
+	 * exceed queueDepth, or a job waited longer than queueWait, for at
+	 * least sustain, the scaler adds a worker, up to maxWorkers. A
+	 * worker which found no job for coolDown retires, down to
+	 * minWorkers. Workers only retire while idle and all of them pop
+	 * from the same job list, so no job is dropped or reordered.
+	 * @param elasticity The bounds and triggers of the scaling.
+	 * @param placement Where the workers run, see above.
+	 */
+	void detach(const Elasticity &elasticity, const Placement &placement = Placement())
+	{
+		this->elasticity = elasticity;
+		this->elasticity.minWorkers = std::max<std::size_t>(elasticity.minWorkers, 1);
+		this->elasticity.maxWorkers = std::max(elasticity.maxWorkers, this->elasticity.minWorkers);
+
+		assert((jobList.backend() != QueueBackend::Spsc || this->elasticity.maxWorkers == 1)
+			&& "A Spsc job list supports a single worker only");
+
+		place(placement);
+		scheduling = Scheduling::SharedQueue;
+		resetMetrics(this->elasticity.maxWorkers);
+		elastic = true;
+		activeWorkers = this->elasticity.minWorkers;
+		running = true;
+
+		workThreads.resize(this->elasticity.maxWorkers);
+
+		for (std::size_t i = 0; i < this->elasticity.minWorkers; i++)
+			workThreads[i] = std::thread(&Service::work, this, i);
+
+		scaler = std::thread(&Service::scale, this);
+	}
+
+	/**
+	 * @brief Start a service on a shared executor.
+	 * @details Instead of starting threads of its own, the service posts
+	 * tasks to the executor, which drain the job list. At most workers
+	 * of these tasks run at the same time, so workers stays the
+	 * concurrency limit of the service. The jobs still start in FIFO
+	 * order and the job limit still throttles the callers. After a
+	 * while, a task hands its thread back to the executor, so one busy
+	 * service cannot starve the others.
+	 * The executor has to outlive the join of the service.
+	 * @param executor The executor running the jobs.
+	 * @param workers The maximum amount of jobs running at once.
+	 */
+	void attach(Executor &executor, const std::size_t workers = 1)
+	{
+		assert(jobList.backend() != QueueBackend::Spsc
+			&& "A Spsc job list cannot be drained by executor threads");
+
+		this->executor = &executor;
+		concurrency = workers < 1 ? 1 : workers;
+		resetMetrics(1);
+		running = true;
 	}
 
 	/**
 	 * @brief Close the service. Pending jobs will be resolved.
-	 * @details Adds a final job to the job list queue and closes
-	 * the queue for further input.
+	 * @details Closes the job list for further input. The workers
+	 * resolve the pending jobs and stop as soon as the list is empty.
 	 */
 	void join()
 	{
 		running = false;
+		jobList.close();
 
-		std::mutex joinLock;
-		std::unique_lock<std::mutex> waitLock(joinLock);
+		// Workers waiting for credits have to see the closed job list.
+		if (downstream)
+			downstream->inbound->wake();
 
-		joinCondition.wait(waitLock, [this]{return jobList.empty();});
+		{
+			std::lock_guard<std::mutex> lock(idleMutex);
+			idleCondition.notify_all();
+		}
 
-		for (std::thread &worker : workThreads)
+		if (executor)
 		{
-			jobList.push([]{return;});
-			worker.join();		
+			scheduleDrain();
+
+			std::unique_lock<std::mutex> lock(drainMutex);
+			drainCondition.wait(lock, [this]{return activeDrains == 0 && jobList.empty();});
+			executor = nullptr;
 		}
+
+		if (scaler.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> lock(scaleMutex);
+				scaleCondition.notify_all();
+			}
+
+			scaler.join();
+		}
+
+		// Slots of an elastic service may be empty.
+		for (std::thread &worker : workThreads)
+			if (worker.joinable())
+				worker.join();
+
+		workThreads.clear();
+		retiredSlots.clear();
+		localJobs.clear();
 	}
 
 	std::size_t totalJobs() const
@@ -75,14 +322,306 @@ public:
 		return jobCount;
 	}
 
+	/**
+	 * @brief Getter for the amount of running worker threads.
+	 * @details Changes over time for an elastic service.
+	 */
+	std::size_t currentWorkers() const
+	{
+		return activeWorkers;
+	}
+
+	/**
+	 * @brief Getter for the amount of queued jobs.
+	 * @details With work stealing, this includes the jobs in the deques
+	 * of all workers.
+	 */
 	std::size_t currentJobs() const
 	{
+		if (scheduling == Scheduling::WorkStealing)
+			return pendingJobs;
+
 		return jobList.size();
 	}
 
+	/**
+	 * @brief Queues a plain job.
+	 * @details Unlike makePromise, the job is not bound to a promise.
+	 * Continuations and coroutines use this to get back onto the
+	 * workers of a service. The job limit and the job time out apply.
+	 * @param job The job to run on a worker of this service.
+	 * @param priority The lane of the job.
+	 * @param deadline The job is cancelled instead of run, if a worker
+	 * gets to it only after this point in time.
+	 * @return False if the service is not running or the job list
+	 * was full. The job is left untouched then.
+	 */
+	bool post(Job &&job, const Priority priority = Priority::Normal,
+		const Deadline deadline = Deadline::max())
+	{
+		if (!running)
+		{
+			countRejection();
+			return false;
+		}
+
+		return submit(std::move(job), priority, deadline);
+	}
+
+	/**
+	 * @brief Queues a plain job without waiting for room.
+	 * @details Like post, but a full job list fails the job right away,
+	 * whatever the overflow policy. Continuations use this, so the
+	 * worker which completes a future never waits for another service.
+	 * A job which is not taken is cancelled with an Overloaded error.
+	 * @return False if the job was cancelled.
+	 */
+	bool tryPost(Job &&job, const Priority priority = Priority::Normal,
+		const Deadline deadline = Deadline::max())
+	{
+		if (running && submit(std::move(job), priority, deadline, false))
+			return true;
+
+		if (!running)
+			countRejection();
+
+		job.cancel(std::make_exception_ptr(Overloaded(name)));
+		return false;
+	}
+
+	/**
+	 * @brief Samples the instrumentation of the service.
+	 * @details Can be called at any time while the service runs, and
+	 * after it was joined. The workers keep recording meanwhile, so
+	 * the values of a snapshot may be a few jobs apart. Detaching or
+	 * attaching the service again starts from zero.
+	 * If NSA_DISABLE_METRICS is defined, every value is zero.
+	 * @return The latency histograms of the jobs, the busy and idle
+	 * time of each worker and the counters of the job list.
+	 */
+	MetricsSnapshot metrics() const
+	{
+		MetricsSnapshot snapshot;
+
+#if NSA_METRICS_ENABLED
+		for (const std::unique_ptr<WorkerMetrics> &worker : workerMetrics)
+		{
+			snapshot.queued.merge(worker->queued.snapshot());
+			snapshot.running.merge(worker->running.snapshot());
+			snapshot.response.merge(worker->response.snapshot());
+			snapshot.workers.push_back(WorkerSnapshot{
+				std::chrono::nanoseconds(worker->busy.load(std::memory_order_relaxed)),
+				std::chrono::nanoseconds(worker->idle.load(std::memory_order_relaxed)),
+				worker->jobs.load(std::memory_order_relaxed)});
+		}
+
+		for (const Priority lane : {Priority::High, Priority::Normal, Priority::Low})
+		{
+			snapshot.highWater = std::max(snapshot.highWater, jobList.highWater(lane));
+			snapshot.contentions += jobList.contentions(lane);
+			snapshot.lockWait += jobList.lockWait(lane);
+		}
+
+		snapshot.timeouts = timeouts.load(std::memory_order_relaxed);
+		snapshot.rejections = rejections.load(std::memory_order_relaxed);
+		snapshot.shed = shed.load(std::memory_order_relaxed);
+		snapshot.overflows = overflows.load(std::memory_order_relaxed);
+#endif
+
+		return snapshot;
+	}
+
+	/**
+	 * @brief Check to see if the calling thread is running a job of
+	 * this service.
+	 */
+	bool onWorkerThread() const
+	{
+		return currentWorker().service == this;
+	}
+
+	/**
+	 * @brief Getter for the name of the service.
+	 */
+	const std::string &serviceName() const
+	{
+		return name;
+	}
+
 	void jobTimeOut(std::chrono::milliseconds timeOut)
 	{
-		timeOut = timeOut;
+		this->timeOut = timeOut;
+	}
+
+	std::chrono::milliseconds jobTimeOut() const
+	{
+		return timeOut;
+	}
+
+	/**
+	 * @brief Takes the place of an idle worker, to run a job of this
+	 * service on the calling thread.
+	 * @details Succeeds only while no job is queued and fewer jobs run
+	 * than the service has workers, or executor tasks with an executor.
+	 * A worker which pops a job meanwhile waits for the place to be
+	 * handed back, so the service never runs more jobs at once than it
+	 * has workers. The job run on the borrowed place should be short.
+	 * @return True if the place was taken. Hand it back with
+	 * returnWorker then.
+	 */
+	bool borrowWorker()
+	{
+		if (!running || currentJobs() != 0)
+			return false;
+
+		if (executor)
+		{
+			std::size_t active = activeDrains.load();
+
+			while (active < concurrency)
+				if (activeDrains.compare_exchange_weak(active, active + 1))
+					return true;
+
+			return false;
+		}
+
+		std::size_t busy = busyWorkers.load();
+
+		while (busy < activeWorkers.load())
+			if (busyWorkers.compare_exchange_weak(busy, busy + 1))
+				return true;
+
+		return false;
+	}
+
+	/**
+	 * @brief Hands back a place taken by borrowWorker.
+	 */
+	void returnWorker()
+	{
+		if (!executor)
+		{
+			busyWorkers.fetch_sub(1);
+			return;
+		}
+
+		// Like the end of a drain task, jobs may have queued meanwhile.
+		std::lock_guard<std::mutex> lock(drainMutex);
+		activeDrains--;
+		scheduleDrain();
+
+		if (!running)
+			drainCondition.notify_all();
+	}
+
+	/**
+	 * @brief Sets what a submission does if its lane is full.
+	 * @details With Block, the caller waits up to the job time out.
+	 * Reject and DropOldest never block the caller: Reject fails the
+	 * new job, DropOldest fails the job of the lane which was queued
+	 * first and queues the new one instead. With the Ordered backend
+	 * that is not the job which would run next, the most urgent jobs
+	 * stay queued. Failed jobs of makePromise
+	 * complete their future with an Overloaded error. DropOldest needs
+	 * the Locked or Ordered backend, the lock-free backends reject.
+	 * Has to be set before the service is detached.
+	 * @param policy The overflow policy.
+	 */
+	void jobOverflow(const Overflow policy)
+	{
+		overflow = policy;
+	}
+
+	/**
+	 * @brief Sets how many jobs a worker takes per wakeup.
+	 * @details A worker drains up to size jobs from the job list with a
+	 * single lock and runs them back to back. Larger batches amortise
+	 * the queue overhead of many small jobs. Long running jobs should
+	 * keep the default of one, so that idle workers can pick up the
+	 * remaining jobs. Has to be set before the service is detached.
+	 * @param size The maximum amount of jobs per batch.
+	 */
+	void jobBatchSize(const std::size_t size)
+	{
+		batchSize = size < 1 ? 1 : size;
+	}
+
+	/**
+	 * @brief Sets the job limit of a single priority lane.
+	 * @details A full lane only blocks the callers of its own
+	 * priority, so a flood of low priority jobs cannot hold back high
+	 * priority ones. Has to be set before the service is detached.
+	 * @param lane The priority of the lane.
+	 * @param limit The maximum of queued jobs. Zero means unlimited.
+	 */
+	void jobLimit(const Priority lane, const std::size_t limit)
+	{
+		jobList.limit(lane, limit);
+	}
+
+	/**
+	 * @brief Splits the job list into shards.
+	 * @details Each priority lane gets count queues, and every calling
+	 * thread pushes into one of them, so many callers of a hot service
+	 * no longer serialize on a single lock. The workers drain the
+	 * shards round robin. The job limit still applies to the whole
+	 * lane and currentJobs stays exact. Jobs of a single caller keep
+	 * their order, jobs of different callers only roughly. A Spsc job
+	 * list keeps a single shard. Has to be set before the service is
+	 * detached.
+	 * @param count The amount of shards per lane. One turns sharding
+	 * off.
+	 */
+	void jobShards(const std::size_t count)
+	{
+		jobList.shard(count);
+	}
+
+	/**
+	 * @brief Declares that the jobs of this service forward into
+	 * another service.
+	 * @details The free room of the Normal lane of downstream is handed
+	 * out as credits. A worker of this service takes a credit before it
+	 * pops a job, and the job spends it on its first submission to
+	 * downstream. Downstream returns the credit as soon as it popped
+	 * that job. So a full downstream holds back the workers of this
+	 * service between two jobs, with their jobs still queued here,
+	 * instead of blocking them inside a job.
+	 * A job which does not forward returns its credit when it is done.
+	 * An idle worker holds up to a batch of credits while it waits for
+	 * jobs, so downstream should have room for at least as many jobs as
+	 * this service has workers. Submissions of unlinked callers are
+	 * not counted and may still take the room of linked ones.
+	 * Links only hold back workers of the shared queue. A downstream
+	 * without a job limit has no credits, so the link does nothing. Has
+	 * to be called before either service is detached.
+	 * @param downstream The service receiving the jobs of this one.
+	 */
+	void link(Service &downstream)
+	{
+		const std::size_t room = downstream.jobList.max(Priority::Normal);
+
+		if (room == std::numeric_limits<std::size_t>::max())
+			return;
+
+		if (!downstream.inbound)
+			downstream.inbound.reset(new Credits<>(room));
+
+		this->downstream = &downstream;
+	}
+
+	/**
+	 * @brief Sets the share of a priority lane.
+	 * @details While every lane has jobs, a worker takes weight jobs of
+	 * a lane before it moves on to the next lower one. The defaults are
+	 * 8 High, 2 Normal and 1 Low. Has to be set before the service is
+	 * detached.
+	 * @param lane The priority of the lane.
+	 * @param weight Jobs per round. At least one.
+	 */
+	void laneWeight(const Priority lane, const std::size_t weight)
+	{
+		jobList.weight(lane, weight);
 	}
 
 protected:
@@ -92,24 +631,38 @@ protected:
 	 * defines how to create a promise future pair.
 	 * 
 	 * The job will be added to the queue, where as the future
-	 * is returned to the caller.
+	 * is returned to the caller. The job and the promise are moved
+	 * into a single Job, so a job with a few small arguments is queued
+	 * without any allocation. The promise and the future share one
+	 * state, which comes from a pool of this service.
+	 * 
+	 * A job which is still queued at its deadline is dropped, and the
+	 * future receives a DeadlineExceeded error. A job which does not
+	 * fit into the job list, see jobOverflow, gets a future which
+	 * already holds an Overloaded error.
 	 * 
 	 * @param  Any given function which acts as a job.
+	 * @param priority The lane of the job.
+	 * @param deadline The point in time after which the job is dropped.
 	 * @tparam T The return value type of the job.
 	 * @return Returns the future for the job.
 	 */
-	template <class T>
-	Service::Future<T> makePromise(std::function<void(Service::Promise<T>)> job)
+	template <class T, class Function>
+	Service::Future<T> makePromise(Function &&job, const Priority priority = Priority::Normal,
+		const Deadline deadline = Deadline::max())
 	{
-		Service::Promise<T> promise(new std::promise<T>);
-		Service::Future<T> future(new std::future<T>);
-		*future = promise->get_future();
+		Service::Promise<T> promise(statePool<T>());
+		Service::Future<T> future = promise->get_future();
 
 		if (running)
 		{
-			if (!jobList.push(std::bind(job, promise), timeOut))
-				printf("%s: Job timed out. Timeout is at %d\n", name.c_str(), timeOut);
+			typedef PromisedJob<T, typename std::decay<Function>::type> Callable;
+
+			if (!submit(Callable{std::forward<Function>(job), promise}, priority, deadline))
+				promise->set_exception(std::make_exception_ptr(Overloaded(name)));
 		}
+		else
+			countRejection();
 
 		return future;	
 	}
@@ -117,7 +670,7 @@ protected:
 	/**
 	 * @brief A helper macro to create a promise.
 	 * @details Using the makePromise function is a bit tricky. You have to
-	 * use std::bind to create a std::function object which in turn is
+	 * use std::bind to create a callable object which in turn is
 	 * accepted by the makePromise function.
 	 * 
 	 * @param functionName The function which acts as the job.
@@ -127,38 +680,877 @@ protected:
 	 */
 #define NSA_MAKE_PROMISE(functionName, returnValueType, ...) return makePromise<returnValueType>(std::bind(&functionName, this, std::placeholders::_1, ##__VA_ARGS__))
 
+	/**
+	 * @brief Same as NSA_MAKE_PROMISE, but queues the job with a priority.
+	 * @param priority The NSA::Priority of the job.
+	 */
+#define NSA_MAKE_PRIORITY_PROMISE(priority, functionName, returnValueType, ...) return makePromise<returnValueType>(std::bind(&functionName, this, std::placeholders::_1, ##__VA_ARGS__), priority)
+
+	/**
+	 * @brief Same as NSA_MAKE_PROMISE, but drops the job if it is still
+	 * queued at the deadline.
+	 * @param deadline The Service::Deadline of the job.
+	 */
+#define NSA_MAKE_DEADLINE_PROMISE(deadline, functionName, returnValueType, ...) return makePromise<returnValueType>(std::bind(&functionName, this, std::placeholders::_1, ##__VA_ARGS__), NSA::Priority::Normal, deadline)
+
 private:
+	/// Amount of promise types per service which get a pool of their own.
+	static constexpr std::size_t MaxPooledTypes = 16;
+
+	/// Jobs an executor task runs before it yields its thread.
+	static constexpr std::size_t DrainBudget = 64;
+
+	/**
+	 * @brief Getter for the promise state pool of a type.
+	 * @details Each service keeps one pool per promise type it uses.
+	 * Pools are created lazily by the first promise of a type. The
+	 * slots are claimed in the order the types come up, starting at a
+	 * slot picked by the type, so the lookup mostly hits right away.
+	 * Types beyond MaxPooledTypes of the same service are allocated on
+	 * the heap.
+	 * @tparam T The value type of the promise.
+	 * @return The pool, or nullptr if the type gets none.
+	 */
+	template <class T>
+	SlabPool *statePool()
+	{
+		const void *type = stateType<T>();
+		const std::size_t first = (reinterpret_cast<std::uintptr_t>(type) >> 4) % MaxPooledTypes;
+
+		for (std::size_t i = 0; i < MaxPooledTypes; i++)
+		{
+			StatePool &slot = statePools[(first + i) % MaxPooledTypes];
+			const void *owner = slot.type.load(std::memory_order_acquire);
+
+			if (owner == nullptr && slot.type.compare_exchange_strong(owner, type, std::memory_order_acq_rel))
+				owner = type;
+
+			if (owner != type)
+				continue;
+
+			SlabPool *pool = slot.pool.load(std::memory_order_acquire);
+
+			if (pool == nullptr)
+			{
+				SlabPool *created = new SlabPool(sizeof(SharedState<T>));
+
+				if (slot.pool.compare_exchange_strong(pool, created, std::memory_order_acq_rel))
+					pool = created;
+				else
+					created->release();
+			}
+
+			return pool;
+		}
+
+		return nullptr;
+	}
+
+	/**
+	 * @brief Process wide identity of a promise type.
+	 */
+	template <class T>
+	static const void *stateType()
+	{
+		static const char tag = 0;
+		return &tag;
+	}
+
+	/// Promise pool of a service, and the type it belongs to.
+	struct StatePool
+	{
+		std::atomic<const void *> type;  ///< Identity of the type, see stateType.
+		std::atomic<SlabPool *> pool;    ///< Created by the first promise.
+	};
+
+	/// Identifies the worker running on the current thread.
+	struct WorkerSlot
+	{
+		Service *service;  ///< The service of the worker, or nullptr.
+		std::size_t index; ///< The index of the worker.
+		Service *credit;   ///< Downstream service the running job holds a credit of.
+	};
+
+	static WorkerSlot &currentWorker()
+	{
+		thread_local WorkerSlot slot = {nullptr, 0, nullptr};
+		return slot;
+	}
+
+	/**
+	 * @brief The job of makePromise.
+	 * @details Hands the promise to the job, or fails it if the job is
+	 * cancelled.
+	 */
+	template <class T, class Function>
+	struct PromisedJob
+	{
+		Function job;
+		Service::Promise<T> promise;
+
+		void operator()()
+		{
+			job(std::move(promise));
+		}
+
+		void cancel(std::exception_ptr error)
+		{
+			promise->set_exception(error);
+		}
+	};
+
+	/// A queued job, its deadline and the time of its submission.
+	struct Task
+	{
+		Task() = default;
+
+		Task(Job &&job, const Deadline deadline, const std::int64_t enqueued) :
+			job(std::move(job)), deadline(deadline), enqueued(enqueued)
+		{}
+
+		/// Earliest deadline first, for the Ordered backend.
+		bool operator<(const Task &other) const
+		{
+			return deadline < other.deadline;
+		}
+
+		Job job;
+		Deadline deadline = Deadline::max();  ///< Drop the job after this.
+		bool credited = false;                ///< Spent a credit of a linked upstream.
+		std::int64_t enqueued = 0;            ///< Time stamp of the submission, if taken.
+#if NSA_TRACING_ENABLED
+		std::uint64_t trace = 0;              ///< Trace id, zero if untraced.
+		std::uint64_t traceJob = 0;           ///< Job id within the trace.
+#endif
+	};
+
+	typedef PriorityLanes<Task> JobLanes;
+
+	/**
+	 * @brief Time stamp for the instrumentation.
+	 * @details Zero if the instrumentation is compiled out, so the
+	 * compiler drops the calls together with the recording.
+	 */
+	static std::int64_t stamp()
+	{
+#if NSA_METRICS_ENABLED
+		return metricsClock();
+#else
+		return 0;
+#endif
+	}
+
+	/**
+	 * @brief Replaces the instrumentation of the workers.
+	 * @param workers The amount of workers which record.
+	 */
+	void resetMetrics(const std::size_t workers)
+	{
+#if NSA_METRICS_ENABLED
+		workerMetrics.clear();
+
+		for (std::size_t i = 0; i < workers; i++)
+			workerMetrics.emplace_back(new WorkerMetrics());
+
+		timeouts = 0;
+		rejections = 0;
+		shed = 0;
+		overflows = 0;
+#else
+		(void)workers;
+#endif
+	}
+
+	void recordJob(const std::size_t worker, const Task &task, const std::int64_t started,
+		const std::int64_t completed)
+	{
+#if NSA_METRICS_ENABLED
+		workerMetrics[worker]->recordJob(task.enqueued, started, completed);
+#else
+		(void)worker; (void)task; (void)started; (void)completed;
+#endif
+	}
+
+	void recordIdle(const std::size_t worker, const std::int64_t since, const std::int64_t until)
+	{
+#if NSA_METRICS_ENABLED
+		workerMetrics[worker]->recordIdle(until - since);
+#else
+		(void)worker; (void)since; (void)until;
+#endif
+	}
+
+	/**
+	 * @brief Gives a job its trace ids, if tracing is on.
+	 * @details A job submitted by a traced job joins its trace.
+	 */
+	void traceSubmit(Task &task)
+	{
+#if NSA_TRACING_ENABLED
+		if (!Trace::enabled())
+			return;
+
+		task.trace = Trace::current();
+
+		if (!task.trace)
+			task.trace = Trace::nextId();
+
+		task.traceJob = Trace::nextId();
+		Trace::record(TracePoint::Submit, traceLabel, task.trace, task.traceJob);
+#else
+		(void)task;
+#endif
+	}
+
+	void traceDequeue(const Task &task)
+	{
+#if NSA_TRACING_ENABLED
+		if (task.trace)
+			Trace::record(TracePoint::Dequeue, traceLabel, task.trace, task.traceJob);
+#else
+		(void)task;
+#endif
+	}
+
+	/**
+	 * @brief Runs a popped job, under its trace id if it has one.
+	 */
+	void runJob(Task &task)
+	{
+#if NSA_TRACING_ENABLED
+		Trace::Scope scope(traceLabel, task.trace, task.traceJob);
+#endif
+		task.job();
+	}
+
+	void countTimeout()
+	{
+#if NSA_METRICS_ENABLED
+		timeouts.fetch_add(1, std::memory_order_relaxed);
+#endif
+	}
+
+	void countRejection()
+	{
+#if NSA_METRICS_ENABLED
+		rejections.fetch_add(1, std::memory_order_relaxed);
+#endif
+	}
+
+	void countOverflow()
+	{
+#if NSA_METRICS_ENABLED
+		overflows.fetch_add(1, std::memory_order_relaxed);
+#endif
+	}
+
+	/**
+	 * @brief Drops a popped job whose deadline passed.
+	 * @details Cancels the job with a DeadlineExceeded error, so the
+	 * future of a promised job does not end up as a broken promise.
+	 * Only reads the clock for jobs with a deadline.
+	 * @return True if the job was dropped.
+	 */
+	bool shedExpired(Task &task)
+	{
+		if (task.deadline == Deadline::max() || std::chrono::steady_clock::now() < task.deadline)
+			return false;
+
+		task.job.cancel(std::make_exception_ptr(DeadlineExceeded(name)));
+		task = Task();
+
+#if NSA_METRICS_ENABLED
+		shed.fetch_add(1, std::memory_order_relaxed);
+#endif
+		return true;
+	}
+
+	/**
+	 * @brief Hands a job to the workers.
+	 * @details With work stealing, a job submitted by one of our own
+	 * workers goes straight into the deque of that worker. The deques
+	 * are not limited by the job limit, so a worker never blocks on its
+	 * own service.
+	 * @param wait False to refuse right away on a full job list, even
+	 * with the Block policy.
+	 * @return False if the job list was full. The job is left
+	 * untouched then.
+	 */
+	bool submit(Job &&job, const Priority priority, const Deadline deadline, const bool wait = true)
+	{
+		// Elastic services need the queue wait even without metrics.
+		Task task(std::move(job), deadline, elastic ? metricsClock() : stamp());
+		WorkerSlot &self = currentWorker();
+		traceSubmit(task);
+
+		if (self.credit == this)
+		{
+			task.credited = true;
+			self.credit = nullptr;
+		}
+
+		if (executor)
+		{
+			if (!enqueue(priority, task, wait))
+				return giveBack(job, task);
+
+			scheduleDrain();
+			return true;
+		}
+
+		if (scheduling != Scheduling::WorkStealing)
+			return enqueue(priority, task, wait) || giveBack(job, task);
+
+		pendingJobs++;
+
+		if (self.service == this)
+			localJobs[self.index]->push(std::move(task));
+		else if (!enqueue(priority, task, wait))
+		{
+			pendingJobs--;
+			return giveBack(job, task);
+		}
+
+		wakeWorker();
+		return true;
+	}
+
+	/**
+	 * @brief Pushes a task into the job list by the overflow policy.
+	 * @return False if the task did not fit. It is left untouched then.
+	 */
+	bool enqueue(const Priority priority, Task &task, const bool wait)
+	{
+		if (overflow == Overflow::Block && wait)
+		{
+			if (jobList.push(priority, std::move(task), timeOut))
+				return true;
+
+			countTimeout();
+			return false;
+		}
+
+		if (overflow != Overflow::DropOldest)
+		{
+			if (jobList.tryPush(priority, std::move(task)))
+				return true;
+
+			countOverflow();
+			return false;
+		}
+
+		Task oldest;
+
+		switch (jobList.forcePush(priority, std::move(task), &oldest))
+		{
+		case PushResult::Pushed:
+			return true;
+
+		case PushResult::Evicted:
+			dropEvicted(oldest);
+			countOverflow();
+			return true;
+
+		default:
+			// A sharded lane closed between the eviction and the push.
+			if (oldest.job)
+				dropEvicted(oldest);
+
+			countOverflow();
+			return false;
+		}
+	}
+
+	/**
+	 * @brief Fails a job which the DropOldest policy took off the job list.
+	 */
+	void dropEvicted(Task &oldest)
+	{
+		if (scheduling == Scheduling::WorkStealing)
+			pendingJobs--;
+
+		returnCredit(oldest);
+		oldest.job.cancel(std::make_exception_ptr(Overloaded(name)));
+	}
+
+	/**
+	 * @brief Hands a job back to the caller after a failed submission.
+	 * @return Always false.
+	 */
+	bool giveBack(Job &job, Task &task)
+	{
+		job = std::move(task.job);
+
+		if (task.credited)
+			currentWorker().credit = this;
+
+		return false;
+	}
+
+	/**
+	 * @brief Hands the credit of a popped task back to the upstream.
+	 */
+	void returnCredit(Task &task)
+	{
+		if (!task.credited)
+			return;
+
+		inbound->release(1);
+		task.credited = false;
+	}
+
+	/**
+	 * @brief Takes up to count credits of the downstream service.
+	 * @details Waits while downstream is full. Gives up once downstream
+	 * stopped, or this service is joined and has no jobs left.
+	 * @return The amount of credits taken.
+	 */
+	std::size_t takeCredits(const std::size_t count)
+	{
+		if (!downstream)
+			return 0;
+
+		return downstream->inbound->acquire(count, [this]
+		{
+			return !downstream->running || (!running && jobList.empty());
+		});
+	}
+
+	/**
+	 * @brief Counts a worker as busy, before it runs popped jobs.
+	 * @details Waits while a borrowWorker holds the last free place.
+	 * The count stays taken meanwhile, so no other borrower gets in.
+	 */
+	void occupy()
+	{
+		if (busyWorkers.fetch_add(1) < activeWorkers.load())
+			return;
+
+		while (busyWorkers.load() > activeWorkers.load())
+			std::this_thread::yield();
+	}
+
+	/**
+	 * @brief Posts a drain task, unless the concurrency limit is reached.
+	 */
+	void scheduleDrain()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::size_t active = activeDrains.load();
+
+		while (active < concurrency && !jobList.empty())
+		{
+			if (activeDrains.compare_exchange_weak(active, active + 1))
+			{
+				executor->post([this]{drain();});
+				return;
+			}
+		}
+	}
+
+	/**
+	 * @brief Executor task running the jobs of this service.
+	 * @details Runs up to DrainBudget jobs, then posts itself again to
+	 * give the other services of the executor a turn.
+	 */
+	void drain()
+	{
+		WorkerSlot &self = currentWorker();
+		const WorkerSlot previous = self;
+		self.service = this;
+		self.index = 0;
+
+		Task currentTask;
+		JobLanes::Cursor cursor;
+		std::size_t done = 0;
+
+		while (done < DrainBudget && jobList.tryPop(cursor, &currentTask))
+		{
+			traceDequeue(currentTask);
+			returnCredit(currentTask);
+
+			if (shedExpired(currentTask))
+				continue;
+
+			const std::int64_t started = stamp();
+			runJob(currentTask);
+			recordJob(0, currentTask, started, stamp());
+			currentTask = Task();
+			jobCount++;
+			done++;
+		}
+
+		self = previous;
+
+		if (done == DrainBudget && !jobList.empty())
+		{
+			executor->post([this]{drain();});
+			return;
+		}
+
+		// Join may destroy the service as soon as it sees the last task
+		// leave, so this is the last time the task touches the service.
+		std::lock_guard<std::mutex> lock(drainMutex);
+		activeDrains--;
+
+		// A job may have been pushed after our last look, while its
+		// producer still saw this task as active.
+		scheduleDrain();
+
+		if (!running)
+			drainCondition.notify_all();
+	}
+
+	/**
+	 * @brief Wakes a single parked worker, if there is one.
+	 */
+	void wakeWorker()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (idleWorkers.load(std::memory_order_relaxed) == 0)
+			return;
+
+		std::lock_guard<std::mutex> lock(idleMutex);
+		idleCondition.notify_one();
+	}
+
+	/**
+	 * @brief Takes the oldest job of another worker.
+	 * @param index The index of the thief.
+	 */
+	bool stealJob(const std::size_t index, Task &task)
+	{
+		const std::size_t workers = localJobs.size();
+
+		for (std::size_t i = 1; i < workers; i++)
+			if (localJobs[(index + i) % workers]->steal(task))
+				return true;
+
+		return false;
+	}
+
+	/**
+	 * @brief The main thread of a work stealing worker.
+	 * @details Runs until the service is joined and no job is left in
+	 * the job list or any deque.
+	 * @param index The index of the worker and its deque.
+	 */
+	void stealWork(const std::size_t index)
+	{
+		WorkerSlot &self = currentWorker();
+		self.service = this;
+		self.index = index;
+
+		placement.pin(index);
+		NodeMemoryScope memory(placement.node());
+
+		WorkStealingDeque<Task> &local = *localJobs[index];
+		Task currentTask;
+		JobLanes::Cursor cursor;
+		std::int64_t idleSince = stamp();
+
+		for (;;)
+		{
+			if (local.pop(currentTask) || jobList.tryPop(cursor, &currentTask) || stealJob(index, currentTask))
+			{
+				pendingJobs--;
+				traceDequeue(currentTask);
+				returnCredit(currentTask);
+
+				if (shedExpired(currentTask))
+					continue;
+
+				const std::int64_t started = stamp();
+				recordIdle(index, idleSince, started);
+
+				occupy();
+				runJob(currentTask);
+				busyWorkers--;
+				idleSince = stamp();
+				recordJob(index, currentTask, started, idleSince);
+				currentTask = Task();
+				jobCount++;
+				continue;
+			}
+
+			// A job is announced, but not yet in a queue.
+			if (pendingJobs > 0)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(idleMutex);
+			idleWorkers++;
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			idleCondition.wait(lock, [this]{return pendingJobs > 0 || !running;});
+			idleWorkers--;
+
+			if (pendingJobs == 0 && !running)
+				break;
+		}
+
+		self.service = nullptr;
+	}
+
+	/**
+	 * @brief Takes over the placement of the workers.
+	 * @details Moves the job list to the memory of the node, if the
+	 * placement names one.
+	 */
+	void place(const Placement &placement)
+	{
+		this->placement = placement;
+
+		if (placement.node() < 0)
+			return;
+
+		NodeMemoryScope memory(placement.node());
+		jobList.relocate();
+	}
+
+	/**
+	 * @brief Publishes the queue wait of a popped job to the scaler.
+	 */
+	void noteWait(const Task &task)
+	{
+		const std::int64_t waited = metricsClock() - task.enqueued;
+		std::int64_t peak = waitPeak.load(std::memory_order_relaxed);
+
+		while (waited > peak && !waitPeak.compare_exchange_weak(peak, waited, std::memory_order_relaxed))
+		{}
+	}
+
+	/**
+	 * @brief Retires an idle elastic worker, unless it is one of the
+	 * last minWorkers.
+	 * @param index The slot of the worker.
+	 * @return True if the worker has to stop.
+	 */
+	bool retire(const std::size_t index)
+	{
+		std::size_t active = activeWorkers.load();
+
+		while (active > elasticity.minWorkers)
+		{
+			if (activeWorkers.compare_exchange_weak(active, active - 1))
+			{
+				std::lock_guard<std::mutex> lock(scaleMutex);
+				retiredSlots.push_back(index);
+
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief The scaler thread of an elastic service.
+	 * @details Samples the job list a few times per sustain period and
+	 * adds a worker once the pressure lasted the whole period. Also
+	 * joins the threads of retired workers, so their slots can be
+	 * reused.
+	 */
+	void scale()
+	{
+		const std::chrono::milliseconds tick =
+			std::max(std::chrono::milliseconds(1), elasticity.sustain / 4);
+		const std::int64_t maxWait = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			elasticity.queueWait).count();
+		std::chrono::milliseconds pressure(0);
+
+		std::unique_lock<std::mutex> lock(scaleMutex);
+
+		while (running)
+		{
+			scaleCondition.wait_for(lock, tick);
+
+			for (const std::size_t slot : retiredSlots)
+				workThreads[slot].join();
+
+			retiredSlots.clear();
+
+			if (currentJobs() > elasticity.queueDepth ||
+				waitPeak.exchange(0, std::memory_order_relaxed) > maxWait)
+				pressure += tick;
+			else
+				pressure = std::chrono::milliseconds(0);
+
+			if (!running || pressure < elasticity.sustain || activeWorkers >= elasticity.maxWorkers)
+				continue;
+
+			// A retiring worker may not have handed in its slot yet.
+			for (std::size_t slot = 0; slot < workThreads.size(); slot++)
+			{
+				if (workThreads[slot].joinable())
+					continue;
+
+				activeWorkers++;
+				workThreads[slot] = std::thread(&Service::work, this, slot);
+				break;
+			}
+
+			pressure = std::chrono::milliseconds(0);
+		}
+	}
+
 	/**
 	 * @brief The main thread of the serice.
 	 * @details The thread waits for a job to be added into the
 	 * job list. The thread runs until a join is called.
 	 * 
-	 * @param e [description]
+	 * @param index The index of the worker.
 	 */
-	void work()
+	void work(const std::size_t index)
 	{
-		std::function<void()> currentJob;
+		WorkerSlot &self = currentWorker();
+		self.service = this;
+		self.index = index;
 
-		while (running || !jobList.empty())
-		{	
-			jobList.pop(&currentJob);
-			currentJob();
-			jobCount++;
+		placement.pin(index);
+		NodeMemoryScope memory(placement.node());
+
+		std::vector<Task> batch;
+		batch.reserve(batchSize);
+		JobLanes::Cursor cursor;
+		std::int64_t idleSince = stamp();
+
+		for (;;)
+		{
+			// With a link, only pop as many jobs as can be forwarded.
+			std::size_t credits = takeCredits(batchSize);
+			const std::size_t limit = credits ? credits : batchSize;
+
+			const std::size_t popped = elastic
+				? jobList.popBulkFor(cursor, std::back_inserter(batch), limit, elasticity.coolDown)
+				: jobList.popBulk(cursor, std::back_inserter(batch), limit);
+
+			if (!popped)
+			{
+				if (credits)
+					downstream->inbound->release(credits);
+
+				// An elastic worker idled for the cool down.
+				if (elastic && !(jobList.isClosed() && jobList.empty()) && !retire(index))
+					continue;
+
+				break;
+			}
+
+			if (credits > batch.size())
+			{
+				downstream->inbound->release(credits - batch.size());
+				credits = batch.size();
+			}
+
+			std::int64_t started = stamp();
+			recordIdle(index, idleSince, started);
+			occupy();
+
+			std::size_t done = 0;
+
+			for (Task &currentTask : batch)
+				traceDequeue(currentTask);
+
+			for (Task &currentTask : batch)
+			{
+				returnCredit(currentTask);
+
+				if (elastic)
+					noteWait(currentTask);
+
+				if (credits)
+				{
+					self.credit = downstream;
+					credits--;
+				}
+
+				const bool shed = shedExpired(currentTask);
+
+				if (!shed)
+					runJob(currentTask);
+
+				// The job did not forward, so its credit is unused.
+				if (self.credit)
+				{
+					downstream->inbound->release(1);
+					self.credit = nullptr;
+				}
+
+				if (shed)
+					continue;
+
+				// The next job of the batch starts as this one completes.
+				const std::int64_t completed = stamp();
+				recordJob(index, currentTask, started, completed);
+				started = completed;
+				done++;
+			}
+
+			busyWorkers--;
+			idleSince = started;
+			jobCount += done;
+			batch.clear();
 		}
 
-		joinCondition.notify_all();
+		self.service = nullptr;
 	}
 
 protected:
 	std::string name; ///< The name of the job.
 
 private:
-	BlockingQueue<std::function<void()>> jobList; ///< The job list.
+	JobLanes jobList;                             ///< The job list.
 	std::atomic<std::size_t> jobCount;            ///< Total job count.
 	std::atomic<bool> running;                    ///< Status of the service.
 	std::vector<std::thread> workThreads;         ///< Collection of workers.
-	std::condition_variable joinCondition;        ///< Condition for clean up.
+	std::atomic<std::size_t> activeWorkers;       ///< Running worker threads.
 	std::chrono::milliseconds timeOut;            ///< TimeOut to drop job.
+	Overflow overflow;                            ///< Policy for a full lane.
+	std::size_t batchSize;                        ///< Jobs per worker wakeup.
+	StatePool statePools[MaxPooledTypes];         ///< Promise pools by type.
+
+	Scheduling scheduling;                        ///< How workers share jobs.
+	std::vector<std::unique_ptr<WorkStealingDeque<Task>>> localJobs; ///< Deque per worker.
+	std::atomic<std::size_t> pendingJobs;         ///< Jobs queued anywhere.
+	std::atomic<std::size_t> idleWorkers;         ///< Parked stealing workers.
+	std::atomic<std::size_t> busyWorkers;         ///< Workers running jobs, plus borrowers.
+	std::mutex idleMutex;                         ///< Guards parking.
+	std::condition_variable idleCondition;        ///< Wakes parked workers.
+
+	Executor *executor;                           ///< Shared executor, if attached.
+	std::size_t concurrency;                      ///< Executor tasks allowed at once.
+	std::atomic<std::size_t> activeDrains;        ///< Executor tasks in flight.
+	std::mutex drainMutex;                        ///< Guards joining attached services.
+	std::condition_variable drainCondition;       ///< Signals finished executor tasks.
+
+	Service *downstream;                          ///< Linked service receiving our jobs.
+	std::unique_ptr<Credits<>> inbound;           ///< Room handed to linked upstreams.
+
+	Placement placement;                          ///< Where the workers run.
+
+	bool elastic;                                 ///< Workers come and go.
+	Elasticity elasticity;                        ///< Bounds of an elastic service.
+	std::thread scaler;                           ///< Adds elastic workers.
+	std::mutex scaleMutex;                        ///< Guards the worker slots.
+	std::condition_variable scaleCondition;       ///< Stops the scaler.
+	std::vector<std::size_t> retiredSlots;        ///< Slots of retired workers.
+	std::atomic<std::int64_t> waitPeak;           ///< Longest queue wait since the last sample.
+
+#if NSA_METRICS_ENABLED
+	std::vector<std::unique_ptr<WorkerMetrics>> workerMetrics; ///< Instrumentation per worker.
+	std::atomic<std::size_t> timeouts;            ///< Submissions which timed out.
+	std::atomic<std::size_t> rejections;          ///< Submissions to a stopped service.
+	std::atomic<std::size_t> shed;                ///< Jobs dropped after their deadline.
+	std::atomic<std::size_t> overflows;           ///< Jobs refused or evicted by the policy.
+#endif
+
+#if NSA_TRACING_ENABLED
+	std::uint32_t traceLabel;                     ///< Name of the service in the trace.
+#endif
 };
 
 } // namespace NSA
\ No newline at end of file
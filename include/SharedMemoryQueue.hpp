@@ -0,0 +1,856 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "RingBuffer.hpp"
+
+namespace NSA
+{
+
+/*!
+ * @brief Blocking topped queue in POSIX shared memory, for processes on
+ *        the same host.
+ * @details One process creates the queue under a name, the others open
+ *          it. Every process may push and pop. The elements live in
+ *          fixed size slots of the shared mapping, so the element type
+ *          has to be trivially copyable, and must not hold pointers
+ *          into the memory of a single process.
+ *
+ *          Besides push and pop, which copy an element in and out,
+ *          producers can reserve a slot, fill it in place and commit
+ *          it, and consumers can acquire a slot, read it in place and
+ *          release it. Nothing is copied or serialized on the way.
+ *
+ *          The ring works like RingBuffer: every slot carries the
+ *          sequence number of its lap, and next to it the process
+ *          which holds the slot right now. If a process dies while it
+ *          holds a slot, the ring would stop at that slot forever.
+ *          Instead, the next process which finds the slot in its way
+ *          checks whether the holder is still alive. A slot a dead
+ *          producer reserved is skipped by the consumers, a slot a dead
+ *          consumer acquired is handed back to the producers. The
+ *          element in it is lost either way. All processes have to
+ *          share a PID namespace for this, and a forked child has to
+ *          open the queue on its own.
+ *
+ *          The slot holds the process id together with the low bits of
+ *          the start time of the process, so a process which got the
+ *          id of a dead holder is not mistaken for it. Each queue
+ *          looks for dead holders at most every PeerCheck, on each
+ *          side, no matter how often the non blocking calls run.
+ *
+ *          Waiting processes park on futex words inside the mapping, a
+ *          commit wakes a consumer and a release wakes a producer. The
+ *          wake is skipped as long as nobody is parked. Parked
+ *          processes look for dead holders every PeerCheck.
+ *
+ *          A Service in another process consumes the queue with a
+ *          thread which pops and posts:
+ *
+ *              NSA::SharedMemoryQueue<Order> orders;
+ *              orders.open("/orders");
+ *
+ *              Order order;
+ *
+ *              while (orders.pop(&order))
+ *                  kitchen.post(NSA::Job([&kitchen, order]{kitchen.cook(order);}));
+ *
+ * @tparam T The element type. Trivially copyable.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class T>
+class SharedMemoryQueue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Elements in shared memory have to be trivially copyable");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared atomics have to be lock-free");
+
+public:
+    /// How often parked processes look for dead holders of a slot.
+    static constexpr std::chrono::milliseconds PeerCheck{50};
+
+    SharedMemoryQueue() :
+        header(nullptr),
+        slots(nullptr),
+        bytes(0),
+        self(0),
+        producerProbe(0),
+        consumerProbe(0)
+    {}
+
+    ~SharedMemoryQueue()
+    {
+#if defined(__linux__)
+        if (header)
+            munmap(header, bytes);
+#endif
+    }
+
+    SharedMemoryQueue(const SharedMemoryQueue &) = delete;
+    SharedMemoryQueue &operator=(const SharedMemoryQueue &) = delete;
+
+    /**
+     * @brief Creates the shared memory segment of the queue.
+     * @details If the segment exists already, the queue opens it
+     *          instead, see open.
+     * @param name The name of the segment, like "/orders".
+     * @param capacity The top of the queue. Rounded up to a power of
+     *        two, at least two.
+     * @return False if the segment cannot be created, or exists with
+     *         another element size.
+     */
+    bool create(const std::string &name, const std::size_t capacity)
+    {
+#if defined(__linux__)
+        const int file = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+        if (file < 0)
+            return errno == EEXIST && open(name);
+
+        std::size_t slotCount = 2;
+
+        while (slotCount < capacity)
+            slotCount *= 2;
+
+        const std::size_t size = sizeof(Header) + slotCount * sizeof(Slot);
+
+        if (ftruncate(file, size) != 0 || !map(file, size))
+        {
+            ::close(file);
+            shm_unlink(name.c_str());
+            return false;
+        }
+
+        ::close(file);
+
+        new (header) Header();
+        header->capacity = slotCount;
+        header->slotSize = sizeof(Slot);
+
+        for (std::size_t i = 0; i < slotCount; i++)
+            new (&slots[i]) Slot{{word(static_cast<std::uint32_t>(i), 0)}, T()};
+
+        // Openers wait for the magic, so it goes last.
+        header->magic.store(Magic, std::memory_order_release);
+        return true;
+#else
+        (void)name; (void)capacity;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Opens the shared memory segment created by another process.
+     * @param name The name of the segment.
+     * @param timeOut How long to wait for the creator to set it up.
+     * @return False if there is no such segment, or it holds another
+     *         element size.
+     */
+    bool open(const std::string &name, const std::chrono::milliseconds timeOut = std::chrono::milliseconds(1000))
+    {
+#if defined(__linux__)
+        const int file = shm_open(name.c_str(), O_RDWR, 0600);
+
+        if (file < 0)
+            return false;
+
+        const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeOut;
+        struct stat status = {};
+
+        // The creator may still be sizing the segment.
+        while (fstat(file, &status) == 0 && static_cast<std::size_t>(status.st_size) < sizeof(Header))
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+                break;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        const std::size_t size = static_cast<std::size_t>(status.st_size);
+
+        if (size < sizeof(Header) || !map(file, size))
+        {
+            ::close(file);
+            return false;
+        }
+
+        ::close(file);
+
+        while (header->magic.load(std::memory_order_acquire) != Magic && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        if (header->magic.load(std::memory_order_acquire) != Magic || header->slotSize != sizeof(Slot)
+            || sizeof(Header) + header->capacity * sizeof(Slot) != size)
+        {
+            munmap(header, bytes);
+            header = nullptr;
+            return false;
+        }
+
+        return true;
+#else
+        (void)name; (void)timeOut;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Removes the name of a segment.
+     * @details Processes which have the queue open keep using it.
+     */
+    static bool remove(const std::string &name)
+    {
+#if defined(__linux__)
+        return shm_unlink(name.c_str()) == 0;
+#else
+        (void)name;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Blocking and waiting push.
+     * @return True on success. False on a timeout, or if the queue is
+     *         closed.
+     */
+    bool push(const T &src, const std::chrono::milliseconds timeOut = std::chrono::milliseconds(30))
+    {
+        T *slot = reserve(timeOut);
+
+        if (!slot)
+            return false;
+
+        *slot = src;
+        commit(slot);
+
+        return true;
+    }
+
+    /**
+     * @brief Non blocking push.
+     * @return True on success. False if the queue is full or closed.
+     */
+    bool tryPush(const T &src)
+    {
+        T *slot = tryReserve();
+
+        if (!slot)
+            return false;
+
+        *slot = src;
+        commit(slot);
+
+        return true;
+    }
+
+    /**
+     * @brief Blocking and waiting pop.
+     * @details Waits until an element is available, or the queue is
+     *          closed and drained.
+     * @return True on success. False if the queue was closed and is
+     *         drained.
+     */
+    bool pop(T *dst)
+    {
+        const T *slot = acquire();
+
+        if (!slot)
+            return false;
+
+        *dst = *slot;
+        release(slot);
+
+        return true;
+    }
+
+    /**
+     * @brief Pop which waits up to timeOut.
+     * @return True on success. False on a timeout, or if the queue was
+     *         closed and is drained.
+     */
+    bool pop(T *dst, const std::chrono::milliseconds timeOut)
+    {
+        const T *slot = acquire(timeOut);
+
+        if (!slot)
+            return false;
+
+        *dst = *slot;
+        release(slot);
+
+        return true;
+    }
+
+    /**
+     * @brief Non blocking pop.
+     * @return True on success. False if the queue is empty.
+     */
+    bool tryPop(T *dst)
+    {
+        const T *slot = tryAcquire();
+
+        if (!slot)
+            return false;
+
+        *dst = *slot;
+        release(slot);
+
+        return true;
+    }
+
+    /**
+     * @brief Reserves the next free slot, which waits up to timeOut.
+     * @details The slot has to be filled and handed to commit. Slots
+     *          are consumed in the order they were reserved, so a slot
+     *          which stays reserved holds up the consumers.
+     * @return The slot. nullptr on a timeout, or if the queue is closed.
+     */
+    T *reserve(const std::chrono::milliseconds timeOut = std::chrono::milliseconds(30))
+    {
+        T *slot = tryReserve();
+
+        if (!slot && header && !isClosed())
+            park(header->notFull, [this, &slot]{return (slot = tryReserve()) || isClosed();},
+                std::chrono::steady_clock::now() + timeOut);
+
+        return slot;
+    }
+
+    /**
+     * @brief Non blocking reserve.
+     * @return The slot. nullptr if the queue is full or closed.
+     */
+    T *tryReserve()
+    {
+        if (!header || isClosed())
+            return nullptr;
+
+        const std::uint32_t owner = self;
+        std::uint64_t pos = header->tail.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            Slot &slot = slots[pos & (header->capacity - 1)];
+            std::uint64_t current = slot.word.load(std::memory_order_acquire);
+            const std::int32_t diff = static_cast<std::int32_t>(sequenceOf(current) - static_cast<std::uint32_t>(pos));
+
+            if (diff == 0 && tagOf(current) == 0)
+            {
+                if (slot.word.compare_exchange_weak(current, word(sequenceOf(current), owner),
+                    std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    header->tail.compare_exchange_strong(pos, pos + 1, std::memory_order_relaxed);
+                    return &slot.item;
+                }
+            }
+            else if (diff == 0)
+            {
+                // Reserved by another producer, which may not have moved
+                // the tail yet.
+                advance(header->tail, pos);
+            }
+            else if (diff < 0)
+            {
+                // The slot is still acquired by a consumer of the last lap.
+                if (diff != 1 - static_cast<std::int32_t>(header->capacity) || !reclaim(slot, current,
+                    word(static_cast<std::uint32_t>(pos), 0), producerProbe))
+                    return nullptr;
+
+                wake(header->notFull, 1);
+            }
+            else
+            {
+                // Reserved already in this lap. The producer may have died
+                // before it moved the tail.
+                advance(header->tail, pos);
+            }
+        }
+    }
+
+    /**
+     * @brief Hands a filled slot to the consumers.
+     */
+    void commit(T *slot)
+    {
+        Slot &owner = slotOf(slot);
+        const std::uint64_t current = owner.word.load(std::memory_order_relaxed);
+
+        owner.word.store(word(sequenceOf(current) + 1, 0), std::memory_order_release);
+        wake(header->notEmpty, 1);
+    }
+
+    /**
+     * @brief Blocking and waiting acquire of the next filled slot.
+     * @details The slot has to be handed to release once it was read.
+     * @return The slot. nullptr if the queue was closed and is drained.
+     */
+    const T *acquire()
+    {
+        const T *slot = tryAcquire();
+
+        if (!slot && header)
+            park(header->notEmpty, [this, &slot]{return (slot = tryAcquire()) || drained();}, nullptr);
+
+        return slot;
+    }
+
+    /**
+     * @brief Acquire which waits up to timeOut.
+     * @return The slot. nullptr on a timeout, or if the queue was closed
+     *         and is drained.
+     */
+    const T *acquire(const std::chrono::milliseconds timeOut)
+    {
+        const T *slot = tryAcquire();
+
+        if (!slot && header)
+            park(header->notEmpty, [this, &slot]{return (slot = tryAcquire()) || drained();},
+                std::chrono::steady_clock::now() + timeOut);
+
+        return slot;
+    }
+
+    /**
+     * @brief Non blocking acquire.
+     * @return The slot. nullptr if there is no filled slot.
+     */
+    const T *tryAcquire()
+    {
+        if (!header)
+            return nullptr;
+
+        const std::uint32_t owner = self;
+        std::uint64_t pos = header->head.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            Slot &slot = slots[pos & (header->capacity - 1)];
+            std::uint64_t current = slot.word.load(std::memory_order_acquire);
+            const std::uint32_t tag = tagOf(current);
+            const std::int32_t diff = static_cast<std::int32_t>(sequenceOf(current) - static_cast<std::uint32_t>(pos + 1));
+
+            if (diff == 0 && (tag == 0 || tag == Skipped))
+            {
+                if (!slot.word.compare_exchange_weak(current, word(sequenceOf(current), owner),
+                    std::memory_order_acquire, std::memory_order_relaxed))
+                    continue;
+
+                header->head.compare_exchange_strong(pos, pos + 1, std::memory_order_relaxed);
+
+                if (tag == 0)
+                    return &slot.item;
+
+                // Left behind by a dead producer, nothing to read.
+                release(&slot.item);
+                pos = header->head.load(std::memory_order_relaxed);
+            }
+            else if (diff == 0)
+            {
+                // Acquired by another consumer, which may not have moved
+                // the head yet.
+                advance(header->head, pos);
+            }
+            else if (diff < 0)
+            {
+                // The slot is reserved, or still empty.
+                if (diff != -1 || tag == 0 || !reclaim(slot, current, word(sequenceOf(current) + 1, Skipped),
+                    consumerProbe))
+                    return nullptr;
+            }
+            else
+            {
+                // Acquired already in this lap. The consumer may have died
+                // before it moved the head.
+                advance(header->head, pos);
+            }
+        }
+    }
+
+    /**
+     * @brief Hands a read slot back to the producers.
+     */
+    void release(const T *slot)
+    {
+        Slot &owner = slotOf(slot);
+        const std::uint64_t current = owner.word.load(std::memory_order_relaxed);
+
+        owner.word.store(word(sequenceOf(current) - 1 + static_cast<std::uint32_t>(header->capacity), 0),
+            std::memory_order_release);
+        wake(header->notFull, 1);
+    }
+
+    /**
+     * @brief Closes the queue for further input, in every process.
+     * @details Slots reserved before can still be committed. Once the
+     *          queue is drained, every blocked and every following pop
+     *          returns false.
+     */
+    void close()
+    {
+        if (!header)
+            return;
+
+        header->closed.store(1, std::memory_order_seq_cst);
+        wake(header->notEmpty, INT_MAX);
+        wake(header->notFull, INT_MAX);
+    }
+
+    /**
+     * @brief Check to see if the queue was closed.
+     */
+    bool isClosed() const
+    {
+        return header && header->closed.load(std::memory_order_acquire) != 0;
+    }
+
+    /**
+     * @brief Approximate amount of reserved and filled slots.
+     */
+    std::size_t size() const
+    {
+        if (!header)
+            return 0;
+
+        const std::uint64_t head = header->head.load(std::memory_order_acquire);
+        const std::uint64_t tail = header->tail.load(std::memory_order_acquire);
+
+        return tail > head ? tail - head : 0;
+    }
+
+    /**
+     * @brief Check to see if the queue is empty.
+     */
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Getter for the maximum size of the queue.
+     */
+    std::size_t max() const
+    {
+        return header ? header->capacity : 0;
+    }
+
+    /**
+     * @brief Getter for the amount of slots taken back from dead
+     *        processes, by any process.
+     */
+    std::size_t recovered() const
+    {
+        return header ? header->recovered.load(std::memory_order_relaxed) : 0;
+    }
+
+private:
+    static constexpr std::uint64_t Magic = 0x5545555141534e;  // "NSAQUEU"
+    static constexpr std::uint32_t Skipped = 1u << 31;        ///< Tag of a slot a dead producer left behind.
+    static constexpr unsigned PidBits = 22;                   ///< Process ids stay below PID_MAX_LIMIT.
+    static constexpr std::uint32_t PidMask = (1u << PidBits) - 1;
+    static constexpr std::uint32_t StartMask = (Skipped >> PidBits) - 1;  ///< Start time bits of a tag.
+
+    /// Futex word and parked processes of one side of the queue.
+    struct SharedWait
+    {
+        std::atomic<std::uint32_t> epoch{0};
+        std::atomic<std::uint32_t> waiters{0};
+    };
+
+    struct Header
+    {
+        std::atomic<std::uint64_t> magic{0};
+        std::uint64_t capacity = 0;
+        std::uint64_t slotSize = 0;
+        std::atomic<std::uint32_t> closed{0};
+        std::atomic<std::uint64_t> recovered{0};
+        alignas(CacheLineSize) std::atomic<std::uint64_t> tail{0};
+        alignas(CacheLineSize) std::atomic<std::uint64_t> head{0};
+        alignas(CacheLineSize) SharedWait notEmpty;
+        alignas(CacheLineSize) SharedWait notFull;
+    };
+
+    /// The sequence number of the lap in the upper half, the process holding the slot in the lower half.
+    struct alignas(CacheLineSize) Slot
+    {
+        std::atomic<std::uint64_t> word;
+        T item;
+    };
+
+    static std::uint64_t word(const std::uint32_t sequence, const std::uint32_t tag)
+    {
+        return static_cast<std::uint64_t>(sequence) << 32 | tag;
+    }
+
+    static std::uint32_t sequenceOf(const std::uint64_t word)
+    {
+        return static_cast<std::uint32_t>(word >> 32);
+    }
+
+    static std::uint32_t tagOf(const std::uint64_t word)
+    {
+        return static_cast<std::uint32_t>(word);
+    }
+
+    Slot &slotOf(const T *item) const
+    {
+        return slots[(reinterpret_cast<const unsigned char *>(item) - reinterpret_cast<const unsigned char *>(slots))
+            / sizeof(Slot)];
+    }
+
+    /**
+     * @brief Moves a position on, unless another process did already.
+     * @param pos The position as last seen. Set to the new one.
+     */
+    static void advance(std::atomic<std::uint64_t> &position, std::uint64_t &pos)
+    {
+        if (position.compare_exchange_strong(pos, pos + 1, std::memory_order_relaxed))
+            pos++;
+    }
+
+    /**
+     * @brief Takes a slot away from a dead holder.
+     * @param current The word of the slot, as last seen.
+     * @param replacement The word after the recovery.
+     * @param probe When this side looked for a dead holder last.
+     * @return True if the holder was dead and the slot recovered.
+     */
+    bool reclaim(Slot &slot, std::uint64_t current, const std::uint64_t replacement, std::atomic<std::int64_t> &probe)
+    {
+        const std::uint32_t tag = tagOf(current);
+
+        if (tag == 0 || tag == Skipped || !due(probe) || alive(tag))
+            return false;
+
+        if (slot.word.compare_exchange_strong(current, replacement, std::memory_order_acq_rel))
+            header->recovered.fetch_add(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    /**
+     * @brief Claims the next look for dead holders, at most one every
+     *        PeerCheck.
+     */
+    static bool due(std::atomic<std::int64_t> &probe)
+    {
+        const std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        std::int64_t last = probe.load(std::memory_order_relaxed);
+
+        if (last != 0 && now - last < std::chrono::duration_cast<std::chrono::nanoseconds>(PeerCheck).count())
+            return false;
+
+        // Of the threads racing here, one looks.
+        return probe.compare_exchange_strong(last, now, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief The tag of the slots a process holds.
+     * @return The process id, with the low bits of its start time above.
+     */
+    static std::uint32_t holder(const std::uint32_t pid, const std::uint64_t started)
+    {
+        return pid | (static_cast<std::uint32_t>(started) & StartMask) << PidBits;
+    }
+
+    /**
+     * @brief Reads the state and the start time of a process.
+     * @return False if the process has no entry in /proc.
+     */
+    static bool status(const std::uint32_t pid, char &state, std::uint64_t &started)
+    {
+#if defined(__linux__)
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+
+        FILE *file = fopen(path, "r");
+
+        if (!file)
+            return false;
+
+        char line[1024];
+        const bool read = fgets(line, sizeof(line), file) != nullptr;
+        fclose(file);
+
+        // The fields follow the name, which is in parentheses. The
+        // state is the third of them, the start time the 22nd.
+        const char *name = read ? strrchr(line, ')') : nullptr;
+        unsigned long long ticks = 0;
+
+        if (!name || sscanf(name + 1, " %c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu",
+            &state, &ticks) != 2)
+            return false;
+
+        started = ticks;
+        return true;
+#else
+        (void)pid; (void)state; (void)started;
+        return false;
+#endif
+    }
+
+    static bool alive(const std::uint32_t tag)
+    {
+#if defined(__linux__)
+        const std::uint32_t pid = tag & PidMask;
+
+        if (kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH)
+            return false;
+
+        char state = 0;
+        std::uint64_t started = 0;
+
+        if (!status(pid, state, started))
+            return true;
+
+        // A dead process nobody reaped yet still answers the signal, and
+        // a process which started later only got the id of the holder.
+        return state != 'Z' && state != 'X' && holder(pid, started) == tag;
+#else
+        (void)tag;
+        return true;
+#endif
+    }
+
+    bool drained() const
+    {
+        return isClosed() && empty();
+    }
+
+    bool map(const int file, const std::size_t size)
+    {
+#if defined(__linux__)
+        void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+
+        if (memory == MAP_FAILED)
+            return false;
+
+        header = static_cast<Header *>(memory);
+        slots = reinterpret_cast<Slot *>(static_cast<unsigned char *>(memory) + sizeof(Header));
+        bytes = size;
+        const std::uint32_t pid = static_cast<std::uint32_t>(getpid());
+        char state = 0;
+        std::uint64_t started = 0;
+
+        self = status(pid, state, started) ? holder(pid, started) : pid;
+
+        return true;
+#else
+        (void)file; (void)size;
+        return false;
+#endif
+    }
+
+    template <class Predicate>
+    bool park(SharedWait &wait, Predicate predicate, const std::chrono::steady_clock::time_point deadline)
+    {
+        return park(wait, predicate, &deadline);
+    }
+
+    /**
+     * @brief Parks on a futex word of the mapping until the predicate
+     *        holds, or the deadline passed.
+     * @details Wakes up every PeerCheck, so a slot held by a dead
+     *          process is found even if nobody wakes us.
+     */
+    template <class Predicate>
+    bool park(SharedWait &wait, Predicate predicate, const std::chrono::steady_clock::time_point *deadline)
+    {
+        wait.waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        bool result = false;
+
+        for (;;)
+        {
+            // Read the epoch before the predicate, see SpinFutexWait.
+            const std::uint32_t seen = wait.epoch.load(std::memory_order_acquire);
+
+            if ((result = predicate()))
+                break;
+
+            std::chrono::nanoseconds slice = PeerCheck;
+
+            if (deadline)
+            {
+                const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+                if (now >= *deadline)
+                    break;
+
+                if (*deadline - now < slice)
+                    slice = *deadline - now;
+            }
+
+#if defined(__linux__)
+            struct timespec relative;
+            relative.tv_sec = static_cast<time_t>(slice.count() / 1000000000);
+            relative.tv_nsec = static_cast<long>(slice.count() % 1000000000);
+
+            // Not FUTEX_PRIVATE, the word is shared with other processes.
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&wait.epoch), FUTEX_WAIT, seen, &relative,
+                nullptr, 0);
+#else
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+        }
+
+        wait.waiters.fetch_sub(1, std::memory_order_relaxed);
+
+        return result;
+    }
+
+    /**
+     * @brief Wakes parked processes, if there are any.
+     */
+    void wake(SharedWait &wait, const int count)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (wait.waiters.load(std::memory_order_relaxed) == 0)
+            return;
+
+        wait.epoch.fetch_add(1, std::memory_order_release);
+
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&wait.epoch), FUTEX_WAKE, count, nullptr, nullptr, 0);
+#else
+        (void)count;
+#endif
+    }
+
+    Header *header;        ///< Start of the mapping, nullptr until created or opened.
+    Slot *slots;           ///< The ring, right behind the header.
+    std::size_t bytes;     ///< Size of the mapping.
+    std::uint32_t self;    ///< Process id and start time at create or open, the tag of the slots this process holds.
+    std::atomic<std::int64_t> producerProbe;  ///< When tryReserve looked for a dead holder last.
+    std::atomic<std::int64_t> consumerProbe;  ///< When tryAcquire looked for a dead holder last.
+};
+
+template <class T>
+constexpr std::chrono::milliseconds SharedMemoryQueue<T>::PeerCheck;
+
+} // namespace NSA
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "RingBuffer.hpp"
+
+namespace NSA
+{
+
+/*!
+ * @brief Pool of equally sized memory blocks.
+ * @details Blocks are carved out of slabs, which hold many blocks each
+ *          and are allocated in one go. Freed blocks are kept in a
+ *          lock-free ring and handed out again, so in the steady state
+ *          allocate and deallocate never touch the heap or a lock.
+ *          The pool stops growing at maxBlocks. Afterwards allocate
+ *          returns nullptr and the caller has to fall back to the heap.
+ *
+ *          The pool is reference counted, because blocks may outlive
+ *          the owner of the pool. The owner holds one reference and
+ *          each handed out block holds another one. The pool deletes
+ *          itself once the last reference is gone, so it has to be
+ *          created with new.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+class SlabPool
+{
+public:
+    /**
+     * @param blockSize The size of a single block.
+     * @param blocksPerSlab The amount of blocks allocated at once.
+     * @param maxBlocks The maximum amount of pooled blocks.
+     */
+    SlabPool(const std::size_t blockSize, const std::size_t blocksPerSlab = 64,
+        const std::size_t maxBlocks = 4096) :
+        blockSize(roundUp(blockSize)),
+        blocksPerSlab(blocksPerSlab < 1 ? 1 : blocksPerSlab),
+        maxBlocks(maxBlocks < 2 ? 2 : maxBlocks),
+        freeBlocks(this->maxBlocks),
+        pooledBlocks(0),
+        references(1)
+    {}
+
+    SlabPool(const SlabPool &) = delete;
+    SlabPool &operator=(const SlabPool &) = delete;
+
+    /**
+     * @brief Hands out a block.
+     * @return A block of at least blockSize bytes, or nullptr if the
+     *         pool is exhausted.
+     */
+    void *allocate()
+    {
+        void *block = nullptr;
+
+        if (!freeBlocks.tryPop(block))
+            block = grow();
+
+        if (block)
+            references.fetch_add(1, std::memory_order_relaxed);
+
+        return block;
+    }
+
+    /**
+     * @brief Returns a block handed out by allocate.
+     */
+    void deallocate(void *block)
+    {
+        freeBlocks.tryPush(std::move(block));
+        release();
+    }
+
+    /**
+     * @brief Drops the reference of the owner.
+     */
+    void release()
+    {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    /**
+     * @brief Check to see if objects of a type can live in this pool.
+     */
+    template <class T>
+    static constexpr bool fits()
+    {
+        return alignof(T) <= alignof(std::max_align_t);
+    }
+
+private:
+    ~SlabPool() = default;
+
+    static std::size_t roundUp(const std::size_t size)
+    {
+        const std::size_t alignment = alignof(std::max_align_t);
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    void *grow()
+    {
+        std::lock_guard<std::mutex> lock(slabMutex);
+
+        if (pooledBlocks + blocksPerSlab > maxBlocks)
+            return nullptr;
+
+        // Operator new aligns for every fundamental type.
+        unsigned char *slab = static_cast<unsigned char *>(::operator new(blockSize * blocksPerSlab));
+        slabs.push_back(std::unique_ptr<unsigned char, Deleter>(slab));
+        pooledBlocks += blocksPerSlab;
+
+        for (std::size_t i = 1; i < blocksPerSlab; i++)
+        {
+            void *block = slab + i * blockSize;
+            freeBlocks.tryPush(std::move(block));
+        }
+
+        return slab;
+    }
+
+    struct Deleter
+    {
+        void operator()(unsigned char *slab) const
+        {
+            ::operator delete(slab);
+        }
+    };
+
+    const std::size_t blockSize;
+    const std::size_t blocksPerSlab;
+    const std::size_t maxBlocks;
+    RingBuffer<void *> freeBlocks;              ///< Blocks ready to be handed out.
+    std::mutex slabMutex;                       ///< Guards growing the pool.
+    std::vector<std::unique_ptr<unsigned char, Deleter>> slabs;
+    std::size_t pooledBlocks;                   ///< Blocks in all slabs.
+    std::atomic<std::size_t> references;        ///< Owner plus handed out blocks.
+};
+
+} // namespace NSA
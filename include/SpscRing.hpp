@@ -0,0 +1,210 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "RingBuffer.hpp"
+
+namespace NSA
+{
+
+/*!
+ * @brief Wait-free bounded single producer single consumer ring buffer.
+ * @details Push and pop each finish in a constant amount of steps. The
+ *          producer only writes the tail, the consumer only writes the
+ *          head, and the two are published with acquire/release
+ *          semantics. Each side keeps a cached copy of the other side's
+ *          position, so the shared cache line is only read when the
+ *          ring looks full or empty.
+ *          Exactly one thread may push and exactly one thread may pop.
+ *          In debug builds the first pushing and the first popping
+ *          thread are remembered and any other thread trips an assert.
+ *          The slots are raw storage, like the cells of RingBuffer, so
+ *          T does not have to be default constructible.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class T>
+class SpscRing
+{
+public:
+    SpscRing(const std::size_t capacity);
+    ~SpscRing();
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    /**
+     * @brief Non blocking push. Producer thread only.
+     * @details The src parameter is only moved from if the push
+     *          succeeds. On failure it is left untouched.
+     *
+     * @param src The item to move into the ring.
+     * @return True on success. False if the ring is full.
+     */
+    bool tryPush(T &&src);
+
+    /**
+     * @brief Non blocking pop. Consumer thread only.
+     * @param dst The storage of the popped element.
+     * @return True on success. False if the ring is empty.
+     */
+    bool tryPop(T &dst);
+
+    /**
+     * @brief Approximate amount of elements in the ring.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Getter for the capacity of the ring.
+     */
+    std::size_t capacity() const;
+
+private:
+#ifndef NDEBUG
+    static void checkOwner(std::atomic<std::thread::id> &owner);
+#endif
+
+    struct alignas(CacheLineSize) Producer
+    {
+        std::atomic<std::size_t> tail;
+        std::size_t cachedHead;
+#ifndef NDEBUG
+        std::atomic<std::thread::id> owner;
+#endif
+    };
+
+    struct alignas(CacheLineSize) Consumer
+    {
+        std::atomic<std::size_t> head;
+        std::size_t cachedTail;
+#ifndef NDEBUG
+        std::atomic<std::thread::id> owner;
+#endif
+    };
+
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T &data()
+        {
+            return *reinterpret_cast<T *>(storage);
+        }
+    };
+
+    Producer producer;
+    Consumer consumer;
+    alignas(CacheLineSize) const std::size_t slotCount;
+    std::unique_ptr<Slot[]> slots;
+};
+
+/// Implementation.
+
+template <class T>
+SpscRing<T>::SpscRing(const std::size_t capacity) :
+    slotCount(capacity < 1 ? 1 : capacity),
+    slots(new Slot[slotCount])
+{
+    producer.tail.store(0, std::memory_order_relaxed);
+    producer.cachedHead = 0;
+    consumer.head.store(0, std::memory_order_relaxed);
+    consumer.cachedTail = 0;
+#ifndef NDEBUG
+    producer.owner.store(std::thread::id(), std::memory_order_relaxed);
+    consumer.owner.store(std::thread::id(), std::memory_order_relaxed);
+#endif
+}
+
+template <class T>
+SpscRing<T>::~SpscRing()
+{
+    const std::size_t tail = producer.tail.load(std::memory_order_relaxed);
+
+    for (std::size_t head = consumer.head.load(std::memory_order_relaxed); head != tail; head++)
+        slots[head % slotCount].data().~T();
+}
+
+template <class T>
+bool SpscRing<T>::tryPush(T &&src)
+{
+#ifndef NDEBUG
+    checkOwner(producer.owner);
+#endif
+
+    const std::size_t tail = producer.tail.load(std::memory_order_relaxed);
+
+    if (tail - producer.cachedHead == slotCount)
+    {
+        producer.cachedHead = consumer.head.load(std::memory_order_acquire);
+
+        if (tail - producer.cachedHead == slotCount)
+            return false;
+    }
+
+    new (slots[tail % slotCount].storage) T(std::move(src));
+    producer.tail.store(tail + 1, std::memory_order_release);
+
+    return true;
+}
+
+template <class T>
+bool SpscRing<T>::tryPop(T &dst)
+{
+#ifndef NDEBUG
+    checkOwner(consumer.owner);
+#endif
+
+    const std::size_t head = consumer.head.load(std::memory_order_relaxed);
+
+    if (head == consumer.cachedTail)
+    {
+        consumer.cachedTail = producer.tail.load(std::memory_order_acquire);
+
+        if (head == consumer.cachedTail)
+            return false;
+    }
+
+    T &item = slots[head % slotCount].data();
+    dst = std::move(item);
+    item.~T();
+    consumer.head.store(head + 1, std::memory_order_release);
+
+    return true;
+}
+
+template <class T>
+std::size_t SpscRing<T>::size() const
+{
+    const std::size_t head = consumer.head.load(std::memory_order_acquire);
+    const std::size_t tail = producer.tail.load(std::memory_order_acquire);
+
+    return tail > head ? tail - head : 0;
+}
+
+template <class T>
+inline std::size_t SpscRing<T>::capacity() const
+{
+    return slotCount;
+}
+
+#ifndef NDEBUG
+template <class T>
+void SpscRing<T>::checkOwner(std::atomic<std::thread::id> &owner)
+{
+    const std::thread::id self = std::this_thread::get_id();
+    std::thread::id expected;
+
+    if (!owner.compare_exchange_strong(expected, self))
+        assert(expected == self && "SpscRing used by a second producer or consumer");
+}
+#endif
+
+} // namespace NSA
@@ -0,0 +1,533 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Metrics.hpp"
+
+/**
+ * @brief Compile time switch for the tracing of jobs.
+ * @details Define NSA_ENABLE_TRACING before including any header of the
+ * library to compile the trace points in. Without it every trace point
+ * is an empty function, and Trace::start does nothing.
+ */
+#ifdef NSA_ENABLE_TRACING
+#define NSA_TRACING_ENABLED 1
+#else
+#define NSA_TRACING_ENABLED 0
+#endif
+
+namespace NSA
+{
+
+/// The steps of a job, see Trace.
+enum class TracePoint : std::uint8_t
+{
+    Submit,  ///< The job was handed to a service.
+    Dequeue, ///< A worker took the job from the job list.
+    Start,   ///< The job started running.
+    Finish   ///< The job returned.
+};
+
+/*!
+ * @brief Ring of the trace events of a single thread.
+ * @details Only the owning thread writes, it overwrites the oldest
+ *          events once the ring is full and never waits for anybody.
+ *          Readers copy the ring and drop whatever the writer
+ *          overwrote meanwhile. The fields are relaxed atomics, so a
+ *          concurrent read is torn at worst, never undefined.
+ *          The buffers are kept in a lock-free list and live as long as
+ *          the process. A thread which ends hands its buffer on to the
+ *          next new thread.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+struct TraceBuffer
+{
+    struct Event
+    {
+        std::atomic<std::int64_t> time;    ///< metricsClock of the event.
+        std::atomic<std::uint64_t> trace;  ///< Id of the request the job belongs to.
+        std::atomic<std::uint64_t> job;    ///< Id of the job.
+        std::atomic<std::uint64_t> where;  ///< Point, label and thread, see pack.
+    };
+
+    explicit TraceBuffer(const std::size_t capacity) :
+        events(new Event[capacity]),
+        capacity(capacity),
+        written(0),
+        owned(true),
+        next(nullptr)
+    {}
+
+    /**
+     * @brief Point, label of the service and thread of an event in one word.
+     */
+    static std::uint64_t pack(const TracePoint point, const std::uint32_t label, const std::uint32_t thread)
+    {
+        return static_cast<std::uint64_t>(point) << 56 | static_cast<std::uint64_t>(label & 0xffffff) << 32 | thread;
+    }
+
+    void record(const TracePoint point, const std::uint32_t label, const std::uint32_t thread,
+        const std::uint64_t trace, const std::uint64_t job)
+    {
+        const std::uint64_t position = written.load(std::memory_order_relaxed);
+        Event &event = events[position % capacity];
+
+        event.time.store(metricsClock(), std::memory_order_relaxed);
+        event.trace.store(trace, std::memory_order_relaxed);
+        event.job.store(job, std::memory_order_relaxed);
+        event.where.store(pack(point, label, thread), std::memory_order_relaxed);
+        written.store(position + 1, std::memory_order_release);
+    }
+
+    std::unique_ptr<Event[]> events;
+    const std::size_t capacity;
+    std::atomic<std::uint64_t> written;  ///< Events recorded so far.
+    std::atomic<bool> owned;             ///< Taken by a running thread.
+    TraceBuffer *next;                   ///< Next buffer of the list.
+};
+
+/*!
+ * @brief Records the life of every job, and writes it as a Chrome trace.
+ * @details Every job submitted to a service gets a trace id and a job
+ *          id. A job submitted while another job runs on the same
+ *          thread inherits the trace id of that job. So all jobs of a
+ *          request share one trace id, however many services it
+ *          passes. Services record when a job is submitted, dequeued,
+ *          started and finished.
+ *
+ *          Each thread records into a TraceBuffer of its own, so a
+ *          worker never waits for the tracing. Only the first event of
+ *          a new thread allocates its buffer. If a buffer runs full,
+ *          the oldest events are overwritten.
+ *
+ *          write turns the buffers into the trace event JSON of Chrome,
+ *          which chrome://tracing and the Perfetto UI load as is. Each
+ *          job becomes a slice on the thread which ran it, with a flow
+ *          arrow from the thread which submitted it. Each trace id gets
+ *          a track of its own, which shows the queue waits and runs of
+ *          all its jobs one after the other.
+ *
+ *          Tracing has to be compiled in by NSA_ENABLE_TRACING, and
+ *          switched on by start. Compiled out, nothing is recorded and
+ *          the jobs carry no ids. Compiled in but stopped, a submission
+ *          costs a single relaxed load.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+class Trace
+{
+public:
+    /// Events per thread, unless start is told otherwise.
+    static constexpr std::size_t DefaultEvents = 1 << 14;
+
+    /**
+     * @brief Starts recording.
+     * @param events The size of the buffers of threads which record for
+     *        the first time.
+     */
+    static void start(const std::size_t events = DefaultEvents)
+    {
+#if NSA_TRACING_ENABLED
+        state().events.store(events > 0 ? events : 1, std::memory_order_relaxed);
+        state().on.store(true, std::memory_order_release);
+#else
+        (void)events;
+#endif
+    }
+
+    /**
+     * @brief Stops recording. The recorded events are kept.
+     */
+    static void stop()
+    {
+        state().on.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief Check to see if jobs are traced right now.
+     */
+    static bool enabled()
+    {
+#if NSA_TRACING_ENABLED
+        return state().on.load(std::memory_order_relaxed);
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Registers the name of a service for the trace.
+     * @return The label the events of the service carry.
+     */
+    static std::uint32_t label(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(state().labelMutex);
+
+        state().labels.push_back(name);
+        return static_cast<std::uint32_t>(state().labels.size() - 1);
+    }
+
+    /**
+     * @brief Getter for the trace id of the job running on this thread.
+     * @return Zero if no traced job runs.
+     */
+    static std::uint64_t current()
+    {
+        return local().current;
+    }
+
+    /**
+     * @brief Creates an id for a job or a trace.
+     * @details Unique within the process, without any shared counter.
+     */
+    static std::uint64_t nextId()
+    {
+        Local &self = local();
+        return static_cast<std::uint64_t>(self.thread) << 40 | ++self.ids;
+    }
+
+    /**
+     * @brief Records an event on the buffer of this thread.
+     */
+    static void record(const TracePoint point, const std::uint32_t label, const std::uint64_t trace,
+        const std::uint64_t job)
+    {
+        Local &self = local();
+
+        if (!self.buffer)
+            self.buffer = acquire();
+
+        self.buffer->record(point, label, self.thread, trace, job);
+    }
+
+    /**
+     * @brief Runs a job under its trace id.
+     * @details Records the start and the finish of the job, and makes
+     *          its trace id the current one meanwhile, so the jobs it
+     *          submits inherit it. Does nothing for untraced jobs.
+     */
+    class Scope
+    {
+    public:
+        Scope(const std::uint32_t label, const std::uint64_t trace, const std::uint64_t job) :
+            label(label), trace(trace), job(job), previous(0)
+        {
+            if (!trace)
+                return;
+
+            previous = local().current;
+            local().current = trace;
+            record(TracePoint::Start, label, trace, job);
+        }
+
+        ~Scope()
+        {
+            if (!trace)
+                return;
+
+            record(TracePoint::Finish, label, trace, job);
+            local().current = previous;
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const std::uint32_t label;
+        const std::uint64_t trace;
+        const std::uint64_t job;
+        std::uint64_t previous;  ///< Trace id of the job around this one.
+    };
+
+    /**
+     * @brief Writes the recorded events as a Chrome trace event file.
+     * @details Can be called while jobs are traced. Jobs whose events
+     *          were overwritten, or are still running, are left out.
+     * @return False if the file cannot be written.
+     */
+    static bool write(const std::string &path)
+    {
+        FILE *file = fopen(path.c_str(), "w");
+
+        if (!file)
+            return false;
+
+        write(file);
+
+        return fclose(file) == 0;
+    }
+
+    /**
+     * @brief Writes the recorded events as Chrome trace event JSON.
+     */
+    static void write(FILE *file)
+    {
+        struct Job
+        {
+            std::int64_t times[4] = {0, 0, 0, 0};    ///< By TracePoint, zero if missing.
+            std::uint32_t threads[4] = {0, 0, 0, 0};
+            std::uint32_t label = 0;
+            std::uint64_t trace = 0;
+        };
+
+        std::map<std::uint64_t, Job> jobs;
+        std::int64_t origin = 0;
+
+        for (TraceBuffer *buffer = state().buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+        {
+            const std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+            const std::uint64_t first = written > buffer->capacity ? written - buffer->capacity : 0;
+            std::vector<std::pair<std::uint64_t, TraceBuffer::Event *>> copied;
+
+            for (std::uint64_t i = first; i < written; i++)
+                copied.push_back(std::make_pair(i, &buffer->events[i % buffer->capacity]));
+
+            std::vector<std::pair<std::uint64_t, Job>> read;
+
+            for (const std::pair<std::uint64_t, TraceBuffer::Event *> &entry : copied)
+            {
+                const TraceBuffer::Event &event = *entry.second;
+                const std::uint64_t where = event.where.load(std::memory_order_relaxed);
+                const int point = static_cast<int>(where >> 56);
+
+                if (point > static_cast<int>(TracePoint::Finish))
+                    continue;
+
+                Job job;
+                job.times[point] = event.time.load(std::memory_order_relaxed);
+                job.threads[point] = static_cast<std::uint32_t>(where);
+                job.label = static_cast<std::uint32_t>(where >> 32) & 0xffffff;
+                job.trace = event.trace.load(std::memory_order_relaxed);
+                read.push_back(std::make_pair(event.job.load(std::memory_order_relaxed), job));
+            }
+
+            // Whatever the writer overwrote meanwhile is dropped.
+            const std::uint64_t now = buffer->written.load(std::memory_order_acquire);
+            const std::uint64_t valid = now > buffer->capacity ? now - buffer->capacity : 0;
+
+            for (std::size_t i = 0; i < read.size(); i++)
+            {
+                if (copied[i].first < valid)
+                    continue;
+
+                Job &job = jobs[read[i].first];
+
+                for (int point = 0; point < 4; point++)
+                {
+                    if (!read[i].second.times[point])
+                        continue;
+
+                    job.times[point] = read[i].second.times[point];
+                    job.threads[point] = read[i].second.threads[point];
+                    origin = origin ? std::min(origin, job.times[point]) : job.times[point];
+                }
+
+                job.label = read[i].second.label;
+                job.trace = read[i].second.trace;
+            }
+        }
+
+        std::vector<std::string> labels;
+
+        {
+            std::lock_guard<std::mutex> lock(state().labelMutex);
+
+            for (const std::string &label : state().labels)
+                labels.push_back(escape(label));
+        }
+
+        const auto name = [&labels](const std::uint32_t label)
+        {
+            return label < labels.size() ? labels[label].c_str() : "Service";
+        };
+
+        const auto micros = [origin](const std::int64_t time)
+        {
+            return (time - origin) / 1000.0;
+        };
+
+        const int submit = static_cast<int>(TracePoint::Submit);
+        const int dequeue = static_cast<int>(TracePoint::Dequeue);
+        const int start = static_cast<int>(TracePoint::Start);
+        const int finish = static_cast<int>(TracePoint::Finish);
+
+        fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+        fprintf(file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"NSA\"}}");
+
+        for (const std::pair<const std::uint64_t, Job> &entry : jobs)
+        {
+            const Job &job = entry.second;
+
+            if (!job.times[start] || !job.times[finish])
+                continue;
+
+            // The run on the worker thread.
+            fprintf(file, ",\n{\"name\": \"%s\", \"cat\": \"job\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, "
+                "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"trace\": %llu, \"job\": %llu",
+                name(job.label), job.threads[start], micros(job.times[start]),
+                (job.times[finish] - job.times[start]) / 1000.0,
+                static_cast<unsigned long long>(job.trace), static_cast<unsigned long long>(entry.first));
+
+            if (job.times[submit])
+                fprintf(file, ", \"queued_us\": %.3f", (job.times[start] - job.times[submit]) / 1000.0);
+
+            if (job.times[dequeue])
+                fprintf(file, ", \"dequeued_us\": %.3f", (job.times[dequeue] - job.times[submit]) / 1000.0);
+
+            fprintf(file, "}}");
+
+            // The track of the trace: the wait in the job list, then the run.
+            if (job.times[submit])
+            {
+                fprintf(file, ",\n{\"name\": \"queued on %s\", \"cat\": \"trace\", \"ph\": \"b\", \"id\": %llu, "
+                    "\"pid\": 1, \"tid\": %u, \"ts\": %.3f}", name(job.label),
+                    static_cast<unsigned long long>(job.trace), job.threads[submit], micros(job.times[submit]));
+                fprintf(file, ",\n{\"name\": \"queued on %s\", \"cat\": \"trace\", \"ph\": \"e\", \"id\": %llu, "
+                    "\"pid\": 1, \"tid\": %u, \"ts\": %.3f}", name(job.label),
+                    static_cast<unsigned long long>(job.trace), job.threads[start], micros(job.times[start]));
+
+                // The hand off from the submitting thread to the worker.
+                fprintf(file, ",\n{\"name\": \"submit\", \"cat\": \"flow\", \"ph\": \"s\", \"id\": %llu, "
+                    "\"pid\": 1, \"tid\": %u, \"ts\": %.3f}", static_cast<unsigned long long>(entry.first),
+                    job.threads[submit], micros(job.times[submit]));
+                fprintf(file, ",\n{\"name\": \"submit\", \"cat\": \"flow\", \"ph\": \"f\", \"bp\": \"e\", "
+                    "\"id\": %llu, \"pid\": 1, \"tid\": %u, \"ts\": %.3f}",
+                    static_cast<unsigned long long>(entry.first), job.threads[start], micros(job.times[start]));
+            }
+
+            fprintf(file, ",\n{\"name\": \"%s\", \"cat\": \"trace\", \"ph\": \"b\", \"id\": %llu, "
+                "\"pid\": 1, \"tid\": %u, \"ts\": %.3f}", name(job.label),
+                static_cast<unsigned long long>(job.trace), job.threads[start], micros(job.times[start]));
+            fprintf(file, ",\n{\"name\": \"%s\", \"cat\": \"trace\", \"ph\": \"e\", \"id\": %llu, "
+                "\"pid\": 1, \"tid\": %u, \"ts\": %.3f}", name(job.label),
+                static_cast<unsigned long long>(job.trace), job.threads[finish], micros(job.times[finish]));
+        }
+
+        fprintf(file, "\n]}\n");
+    }
+
+    /**
+     * @brief Forgets all recorded events.
+     * @details Only call it while nothing is traced.
+     */
+    static void clear()
+    {
+        for (TraceBuffer *buffer = state().buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+            buffer->written.store(0, std::memory_order_release);
+    }
+
+private:
+    struct State
+    {
+        std::atomic<bool> on{false};
+        std::atomic<std::size_t> events{DefaultEvents};  ///< Size of new buffers.
+        std::atomic<TraceBuffer *> buffers{nullptr};     ///< Head of the buffer list.
+        std::atomic<std::uint32_t> threads{0};           ///< Threads which traced so far.
+        std::mutex labelMutex;                           ///< Guards labels.
+        std::vector<std::string> labels;                 ///< Service names by label.
+    };
+
+    /// Tracing state of a thread.
+    struct Local
+    {
+        Local() :
+            buffer(nullptr),
+            current(0),
+            ids(0),
+            thread(state().threads.fetch_add(1, std::memory_order_relaxed) + 1)
+        {}
+
+        ~Local()
+        {
+            if (buffer)
+                buffer->owned.store(false, std::memory_order_release);
+        }
+
+        TraceBuffer *buffer;    ///< Buffer of the thread, set on its first event.
+        std::uint64_t current;  ///< Trace id of the running job.
+        std::uint64_t ids;      ///< Ids created by the thread.
+        std::uint32_t thread;   ///< Number of the thread in the trace.
+    };
+
+    /**
+     * @brief The buffers are never freed, so the state is never
+     *        destroyed either, and threads ending after main are safe.
+     */
+    static State &state()
+    {
+        static State *instance = new State();
+        return *instance;
+    }
+
+    static Local &local()
+    {
+        thread_local Local self;
+        return self;
+    }
+
+    /**
+     * @brief Turns a service name into the body of a JSON string.
+     */
+    static std::string escape(const std::string &text)
+    {
+        std::string escaped;
+
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char code[8];
+                snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+                escaped += code;
+            }
+            else
+                escaped += c;
+        }
+
+        return escaped;
+    }
+
+    /**
+     * @brief Takes the buffer of a thread which ended, or adds a new one.
+     */
+    static TraceBuffer *acquire()
+    {
+        for (TraceBuffer *buffer = state().buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next)
+        {
+            bool owned = false;
+
+            if (!buffer->owned.load(std::memory_order_relaxed)
+                && buffer->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+                return buffer;
+        }
+
+        TraceBuffer *created = new TraceBuffer(state().events.load(std::memory_order_relaxed));
+        TraceBuffer *head = state().buffers.load(std::memory_order_relaxed);
+
+        do
+            created->next = head;
+        while (!state().buffers.compare_exchange_weak(head, created, std::memory_order_release,
+            std::memory_order_relaxed));
+
+        return created;
+    }
+};
+
+} // namespace NSA
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__)
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace NSA
+{
+
+/**
+ * @brief Tells the processor that the calling thread is spinning.
+ * @details Frees pipeline resources for the sibling hyper thread and
+ * saves power, without giving up the time slice.
+ */
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/*!
+ * @brief Wait set which parks threads on a condition variable.
+ * @details The default strategy of the BlockingQueue. A waiter parks
+ *          right away. Notifiers only touch the mutex if a waiter is
+ *          registered, so an uncontended queue never locks it.
+ *          A wait set only wakes threads, it does not hold any state.
+ *          Waiters pass a predicate which retries their operation and
+ *          the notifier changes the queue before it notifies.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+class BlockingWait
+{
+public:
+    BlockingWait() : waiters(0) {}
+
+    BlockingWait(const BlockingWait &) = delete;
+    BlockingWait &operator=(const BlockingWait &) = delete;
+
+    /**
+     * @brief Waits until the predicate holds.
+     */
+    template <class Predicate>
+    void wait(Predicate predicate)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        enter();
+        condition.wait(lock, predicate);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Waits until the predicate holds or the deadline passed.
+     * @return The last result of the predicate.
+     */
+    template <class Predicate>
+    bool waitUntil(Predicate predicate, const std::chrono::steady_clock::time_point deadline)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        enter();
+        const bool result = condition.wait_until(lock, deadline, predicate);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+
+        return result;
+    }
+
+    void notifyOne()
+    {
+        if (!hasWaiters())
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        condition.notify_one();
+    }
+
+    void notifyAll()
+    {
+        if (!hasWaiters())
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        condition.notify_all();
+    }
+
+private:
+    // The waiter is published before the predicate is checked, and the
+    // notifier changed the queue before it looks for waiters. So either
+    // the waiter sees the change or the notifier sees the waiter.
+    void enter()
+    {
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    bool hasWaiters() const
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return waiters.load(std::memory_order_relaxed) != 0;
+    }
+
+    std::atomic<std::size_t> waiters;   ///< Threads inside wait.
+    std::mutex mutex;
+    std::condition_variable condition;
+};
+
+/*!
+ * @brief Wait set which never parks.
+ * @details A waiter retries its operation in a loop with a pause
+ *          instruction in between, so it notices a change within a
+ *          few dozen nanoseconds. Notifying costs nothing. In exchange
+ *          every waiter burns a whole core, so this is only useful
+ *          for a dedicated consumer thread per core.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+class SpinWait
+{
+public:
+    SpinWait() = default;
+
+    SpinWait(const SpinWait &) = delete;
+    SpinWait &operator=(const SpinWait &) = delete;
+
+    template <class Predicate>
+    void wait(Predicate predicate)
+    {
+        while (!predicate())
+            cpuRelax();
+    }
+
+    template <class Predicate>
+    bool waitUntil(Predicate predicate, const std::chrono::steady_clock::time_point deadline)
+    {
+        for (std::size_t round = 0; !predicate(); round++)
+        {
+            // Reading the clock costs more than a pause.
+            if (round % ClockInterval == 0 && std::chrono::steady_clock::now() >= deadline)
+                return predicate();
+
+            cpuRelax();
+        }
+
+        return true;
+    }
+
+    void notifyOne()
+    {}
+
+    void notifyAll()
+    {}
+
+private:
+    static constexpr std::size_t ClockInterval = 64;
+};
+
+/*!
+ * @brief Wait set which spins for a while and then parks on a futex.
+ * @details A waiter first retries its operation SpinRounds times with a
+ *          pause instruction. This catches the hand offs of a busy
+ *          queue without any system call. On a single core machine
+ *          the thread it waits for cannot make progress meanwhile, so
+ *          there the waiter parks right away. Afterwards it parks on a
+ *          futex word, which notifiers bump before they wake a single
+ *          waiter, or all of them. Notifiers skip the system call as
+ *          long as nobody is parked.
+ *          On systems without futexes the waiters park on a condition
+ *          variable instead.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+class SpinFutexWait
+{
+public:
+    /// Retries before a waiter parks.
+    static constexpr std::size_t SpinRounds = 256;
+
+    SpinFutexWait() : epoch(0), waiters(0) {}
+
+    SpinFutexWait(const SpinFutexWait &) = delete;
+    SpinFutexWait &operator=(const SpinFutexWait &) = delete;
+
+    template <class Predicate>
+    void wait(Predicate predicate)
+    {
+        waitFor(predicate, nullptr);
+    }
+
+    template <class Predicate>
+    bool waitUntil(Predicate predicate, const std::chrono::steady_clock::time_point deadline)
+    {
+        return waitFor(predicate, &deadline);
+    }
+
+    void notifyOne()
+    {
+        wake(1);
+    }
+
+    void notifyAll()
+    {
+        wake(INT_MAX);
+    }
+
+private:
+    template <class Predicate>
+    bool waitFor(Predicate &predicate, const std::chrono::steady_clock::time_point *deadline)
+    {
+        static const std::size_t rounds = std::thread::hardware_concurrency() > 1 ? SpinRounds : 0;
+
+        for (std::size_t round = 0; round < rounds; round++)
+        {
+            if (predicate())
+                return true;
+
+            cpuRelax();
+        }
+
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        bool result = false;
+
+        for (;;)
+        {
+            // Read the epoch before the predicate. A notifier changes
+            // the queue first and bumps the epoch afterwards, so the
+            // park returns right away if we missed the change.
+            const std::uint32_t seen = epoch.load(std::memory_order_acquire);
+
+            if ((result = predicate()))
+                break;
+
+            if (!deadline)
+            {
+                park(seen, nullptr);
+                continue;
+            }
+
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+            if (now >= *deadline)
+                break;
+
+            const std::chrono::nanoseconds left = *deadline - now;
+            park(seen, &left);
+        }
+
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+
+        return result;
+    }
+
+    void wake(const int count)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (waiters.load(std::memory_order_relaxed) == 0)
+            return;
+
+        epoch.fetch_add(1, std::memory_order_release);
+
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&epoch), FUTEX_WAKE_PRIVATE, count,
+            nullptr, nullptr, 0);
+#else
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (count == 1)
+            condition.notify_one();
+        else
+            condition.notify_all();
+#endif
+    }
+
+    void park(const std::uint32_t seen, const std::chrono::nanoseconds *timeOut)
+    {
+#if defined(__linux__)
+        struct timespec relative;
+
+        if (timeOut)
+        {
+            relative.tv_sec = static_cast<time_t>(timeOut->count() / 1000000000);
+            relative.tv_nsec = static_cast<long>(timeOut->count() % 1000000000);
+        }
+
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&epoch), FUTEX_WAIT_PRIVATE, seen,
+            timeOut ? &relative : nullptr, nullptr, 0);
+#else
+        std::unique_lock<std::mutex> lock(mutex);
+        const auto changed = [this, seen]{return epoch.load(std::memory_order_acquire) != seen;};
+
+        if (timeOut)
+            condition.wait_for(lock, *timeOut, changed);
+        else
+            condition.wait(lock, changed);
+#endif
+    }
+
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+        "The futex word has to be a plain 32 bit integer");
+
+    std::atomic<std::uint32_t> epoch;   ///< Futex word, bumped by every wake.
+    std::atomic<std::size_t> waiters;   ///< Threads which stopped spinning.
+
+#if !defined(__linux__)
+    std::mutex mutex;
+    std::condition_variable condition;
+#endif
+};
+
+} // namespace NSA
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+#include "CircularBuffer.hpp"
+#include "RingBuffer.hpp"
+
+namespace NSA
+{
+
+/*!
+ * @brief Double ended job queue of a single worker.
+ * @details The owning worker pushes and pops at the back, so it keeps
+ *          working on the jobs it just created while their data is
+ *          still in its cache. Other workers steal from the front,
+ *          which holds the oldest jobs.
+ *          Each deque has a lock of its own, which is only contended
+ *          while a steal is going on. Thieves never wait for the lock:
+ *          if a deque is busy they move on to the next victim.
+ *          The deque is unbounded, so a worker never blocks on its own
+ *          queue.
+ *
+ * @date 10.2026
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42)"
+ */
+template <class T>
+class alignas(CacheLineSize) WorkStealingDeque
+{
+public:
+    WorkStealingDeque() : items(0) {}
+
+    /**
+     * @brief Adds an element at the back. Owner only.
+     */
+    void push(T &&src)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer.push(std::move(src));
+        items.store(buffer.size(), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Takes the newest element. Owner only.
+     * @return True on success. False if the deque is empty.
+     */
+    bool pop(T &dst)
+    {
+        if (items.load(std::memory_order_relaxed) == 0)
+            return false;
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (buffer.empty())
+            return false;
+
+        dst = std::move(buffer.back());
+        buffer.popBack();
+        items.store(buffer.size(), std::memory_order_relaxed);
+
+        return true;
+    }
+
+    /**
+     * @brief Takes the oldest element. Any thread.
+     * @return True on success. False if the deque is empty or busy.
+     */
+    bool steal(T &dst)
+    {
+        if (items.load(std::memory_order_relaxed) == 0)
+            return false;
+
+        std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+
+        if (!lock.owns_lock() || buffer.empty())
+            return false;
+
+        dst = std::move(buffer.front());
+        buffer.pop();
+        items.store(buffer.size(), std::memory_order_relaxed);
+
+        return true;
+    }
+
+    /**
+     * @brief Approximate amount of elements in the deque.
+     */
+    std::size_t size() const
+    {
+        return items.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::mutex mutex;
+    CircularBuffer<T> buffer;
+    std::atomic<std::size_t> items;   ///< Lock free hint for thieves.
+};
+
+} // namespace NSA
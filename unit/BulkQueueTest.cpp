@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <iterator>
+#include "BlockingQueue.hpp"
+
+#define ITEMS 10000
+#define BATCH 64
+
+/**
+ * @brief Pushes and pops ITEMS values in batches through a queue.
+ * @param backend The backend under test.
+ * @return True if every value arrived in order.
+ */
+bool transfer(const NSA::QueueBackend backend)
+{
+    NSA::BlockingQueue<int> queue(100, backend);
+    std::vector<int> received;
+
+    std::thread producer([&]()
+    {
+        std::vector<int> batch;
+
+        for (int i = 0; i < ITEMS; i += BATCH)
+        {
+            batch.clear();
+
+            for (int j = i; j < i + BATCH && j < ITEMS; j++)
+                batch.push_back(j);
+
+            std::vector<int>::iterator begin = batch.begin();
+
+            while (begin != batch.end())
+                begin += queue.pushBulk(begin, batch.end(), std::chrono::milliseconds(60000));
+        }
+
+        queue.close();
+    });
+
+    while (queue.popBulk(std::back_inserter(received), BATCH) > 0);
+
+    producer.join();
+
+    if (received.size() != ITEMS)
+        return false;
+
+    for (int i = 0; i < ITEMS; i++)
+        if (received[i] != i)
+            return false;
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (!transfer(NSA::QueueBackend::Locked) ||
+        !transfer(NSA::QueueBackend::Ring) ||
+        !transfer(NSA::QueueBackend::Spsc))
+    {
+        printf("Bulk transfer lost the order of the elements\n");
+        return EXIT_FAILURE;
+    }
+
+    // A bulk push only moves as many elements as fit.
+    NSA::BlockingQueue<int> small(3);
+    std::vector<int> values = {1, 2, 3, 4, 5};
+
+    if (small.pushBulk(values.begin(), values.end()) != 3 ||
+        small.pushBulk(values.begin(), values.end(), std::chrono::milliseconds(5)) != 0)
+    {
+        printf("Bulk push ignored the top of the queue\n");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<int> popped;
+
+    if (small.popBulk(std::back_inserter(popped), 2) != 2 || small.size() != 1)
+    {
+        printf("Bulk pop ignored the maximum count\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
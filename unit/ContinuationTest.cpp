@@ -0,0 +1,221 @@
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "Service.hpp"
+
+class Kitchen : public NSA::Service
+{
+public:
+    Kitchen() : Service("Kitchen service") {}
+
+    Service::Future<int> cook(const int portions)
+    {
+        NSA_MAKE_PROMISE(Kitchen::cookImp, int, portions);
+    }
+
+    Service::Future<void> burn()
+    {
+        NSA_MAKE_PROMISE(Kitchen::burnImp, void);
+    }
+
+private:
+    void cookImp(Service::Promise<int> promise, const int portions)
+    {
+        promise->set_value(portions * 2);
+    }
+
+    void burnImp(Service::Promise<void> promise)
+    {
+        promise->set_exception(std::make_exception_ptr(std::runtime_error("burnt")));
+    }
+};
+
+class Waiter : public NSA::Service
+{
+public:
+    Waiter() : Service("Waiter service") {}
+};
+
+/// Service with room for a single queued job, which blocks on a full list.
+class Counter : public NSA::Service
+{
+public:
+    Counter() : Service("Counter service", 1)
+    {
+        jobTimeOut(std::chrono::seconds(60));
+    }
+};
+
+int main(int argc, char **argv)
+{
+    Kitchen kitchen;
+    Waiter waiter;
+
+    kitchen.detach();
+    waiter.detach();
+
+    // The callback runs on the target service.
+    std::atomic<bool> onWaiter(false);
+    NSA::Future<int> served = kitchen.cook(21).then([&](NSA::Future<int> meal)
+    {
+        onWaiter = waiter.onWorkerThread();
+        return meal.get() + 1;
+    }, waiter);
+
+    if (served.get() != 43 || !onWaiter)
+    {
+        printf("Continuation did not run on the target service\n");
+        return EXIT_FAILURE;
+    }
+
+    // Exceptions pass through a chain.
+    NSA::Future<int> plate = kitchen.burn().then([](NSA::Future<void> meal)
+    {
+        meal.get();
+        return 1;
+    }).then([](NSA::Future<int> meal)
+    {
+        return meal.get() + 1;
+    }, waiter);
+
+    try
+    {
+        plate.get();
+        printf("Exception was not forwarded\n");
+        return EXIT_FAILURE;
+    }
+    catch (const std::runtime_error &)
+    {}
+
+    // A full target fails the callback, the completing worker does not wait.
+    Counter counter;
+    counter.detach();
+
+    NSA::Promise<void> gate;
+    NSA::Future<void> opened = gate.get_future();
+    counter.post(NSA::Job([opened]() mutable {opened.wait();}));
+
+    while (counter.currentJobs() != 0)
+        std::this_thread::yield();
+
+    counter.post(NSA::Job([]{}));
+
+    NSA::Future<int> handed = kitchen.cook(1).then([](NSA::Future<int> meal){return meal.get();}, counter);
+
+    try
+    {
+        handed.get();
+        printf("Continuation waited for a full target\n");
+        return EXIT_FAILURE;
+    }
+    catch (const NSA::Overloaded &)
+    {}
+
+    gate.set_value();
+    counter.join();
+
+    // Chaining to a ready future runs the callback at once.
+    NSA::Promise<int> promise;
+    promise.set_value(5);
+
+    if (promise.get_future().then([](NSA::Future<int> value){return value.get() * 2;}).get() != 10)
+        return EXIT_FAILURE;
+
+    // Every continuation of a future runs, in the order of chaining.
+    NSA::Promise<int> shared;
+    NSA::Future<int> source = shared.get_future();
+    std::vector<int> order;
+
+    NSA::Future<void> firstStep = source.then([&order](NSA::Future<int>){order.push_back(1);});
+    NSA::Future<void> secondStep = source.then([&order](NSA::Future<int>){order.push_back(2);});
+    NSA::Future<std::tuple<NSA::Future<int>>> joined = NSA::when_all(source);
+
+    shared.set_value(7);
+    firstStep.get();
+    secondStep.get();
+
+    if (order != std::vector<int>{1, 2} || !joined.ready() || std::get<0>(joined.get()).get() != 7)
+    {
+        printf("Continuations of the same future were lost\n");
+        return EXIT_FAILURE;
+    }
+
+    // when_all hands back every future, the exception stays in its own.
+    auto all = NSA::when_all(kitchen.cook(1), kitchen.cook(2), kitchen.burn()).get();
+
+    if (std::get<0>(all).get() != 2 || std::get<1>(all).get() != 4)
+        return EXIT_FAILURE;
+
+    try
+    {
+        std::get<2>(all).get();
+        return EXIT_FAILURE;
+    }
+    catch (const std::runtime_error &)
+    {}
+
+    std::vector<NSA::Future<int>> orders;
+
+    for (int i = 0; i < 100; i++)
+        orders.push_back(kitchen.cook(i));
+
+    NSA::Future<int> total = NSA::when_all(orders.begin(), orders.end()).then(
+        [](NSA::Future<std::vector<NSA::Future<int>>> meals)
+    {
+        int sum = 0;
+
+        for (NSA::Future<int> &meal : meals.get())
+            sum += meal.get();
+
+        return sum;
+    }, waiter);
+
+    if (total.get() != 9900)
+    {
+        printf("Wrong sum of all orders\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!NSA::when_all().ready())
+        return EXIT_FAILURE;
+
+    // when_any reports the first ready future, while the other is pending.
+    NSA::Promise<int> never;
+    auto any = NSA::when_any(never.get_future(), kitchen.cook(3)).get();
+
+    if (any.index != 1 || std::get<1>(any.futures).get() != 6 || std::get<0>(any.futures).ready())
+    {
+        printf("when_any picked the wrong future\n");
+        return EXIT_FAILURE;
+    }
+
+    never.set_value(0);
+
+    std::vector<NSA::Future<int>> pending;
+    NSA::Promise<int> first;
+    NSA::Promise<int> second;
+
+    pending.push_back(first.get_future());
+    pending.push_back(second.get_future());
+
+    NSA::Future<std::size_t> winner = NSA::when_any(pending.begin(), pending.end()).then(
+        [](NSA::Future<NSA::WhenAnyResult<std::vector<NSA::Future<int>>>> result)
+    {
+        return result.get().index;
+    });
+
+    second.set_value(2);
+    first.set_value(1);
+
+    if (winner.get() != 1)
+        return EXIT_FAILURE;
+
+    kitchen.join();
+    waiter.join();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,257 @@
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include "Coroutine.hpp"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+/**
+ * @brief A slow downstream service.
+ */
+class Supplier : public NSA::Service
+{
+public:
+    Supplier() : Service("Supplier service")
+    {}
+
+    Service::Future<int> supply(const int amount)
+    {
+        NSA_MAKE_PROMISE(Supplier::supplyImp, int, amount);
+    }
+
+private:
+    void supplyImp(Service::Promise<int> promise, const int amount)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        if (amount < 0)
+            promise->set_exception(std::make_exception_ptr(std::runtime_error("negative")));
+        else
+            promise->set_value(amount);
+    }
+};
+
+/**
+ * @brief A service whose methods are coroutines.
+ * @details The vendor has a single worker, but may have many sales in
+ *          flight, because waiting on the supplier does not block it.
+ */
+class Vendor : public NSA::Service
+{
+public:
+    Vendor(Supplier &supplier) : Service("Vendor service"), supplier(supplier),
+        resumedElsewhere(0), inFlight(0), maxInFlight(0)
+    {}
+
+    Service::Future<int> sell(const int amount)
+    {
+        const int now = ++inFlight;
+
+        if (now > maxInFlight)
+            maxInFlight = now;
+
+        const int supplied = co_await supplier.supply(amount);
+
+        if (!onWorkerThread())
+            resumedElsewhere++;
+
+        inFlight--;
+        co_return supplied + 1;
+    }
+
+    Service::Future<void> restock()
+    {
+        co_await supplier.supply(-1);
+    }
+
+    Supplier &supplier;
+    std::atomic<int> resumedElsewhere;
+    int inFlight;
+    int maxInFlight;
+};
+
+/**
+ * @brief A service with room for a single queued job.
+ */
+class Kiosk : public NSA::Service
+{
+public:
+    explicit Kiosk(const NSA::Overflow policy = NSA::Overflow::Reject) : Service("Kiosk service", 1)
+    {
+        jobOverflow(policy);
+        jobTimeOut(std::chrono::milliseconds(10000));
+    }
+
+    /**
+     * @brief Keeps the single worker busy until the gate opens.
+     */
+    Service::Future<void> block(NSA::Future<void> gate)
+    {
+        NSA_MAKE_PROMISE(Kiosk::blockImp, void, gate);
+    }
+
+    Service::Future<int> sell()
+    {
+        co_return 1;
+    }
+
+    Service::Future<int> resell(NSA::Future<int> price)
+    {
+        co_return co_await price + 1;
+    }
+
+private:
+    void blockImp(Service::Promise<void> promise, NSA::Future<void> gate)
+    {
+        gate.wait();
+        promise->set_value();
+    }
+};
+
+/**
+ * @brief A coroutine which does not fit into the job list fails with
+ *        Overloaded, like a job of NSA_MAKE_PROMISE.
+ */
+static bool refused()
+{
+    Kiosk kiosk;
+    kiosk.detach(1);
+
+    NSA::Promise<void> gate;
+    NSA::Future<void> busy = kiosk.block(gate.get_future());
+
+    while (kiosk.currentJobs() != 0)
+        std::this_thread::yield();
+
+    NSA::Future<int> queued = kiosk.sell();
+    NSA::Future<int> dropped = kiosk.sell();
+    bool overloaded = false;
+
+    try
+    {
+        dropped.get();
+    }
+    catch (const NSA::Overloaded &)
+    {
+        overloaded = true;
+    }
+
+    gate.set_value();
+    busy.get();
+
+    const bool sold = queued.get() == 1;
+    kiosk.join();
+
+    return overloaded && sold;
+}
+
+/**
+ * @brief The awaited future completes while the job list is full. The
+ *        completing thread does not wait for room, and the coroutine
+ *        completes even if its resume job does not stay queued.
+ */
+static bool stalled(const NSA::Overflow policy)
+{
+    Kiosk kiosk(policy);
+    kiosk.detach(1);
+
+    // The worker runs the coroutine up to the await, then blocks.
+    NSA::Promise<int> price;
+    NSA::Future<int> resold = kiosk.resell(price.get_future());
+
+    while (kiosk.currentJobs() != 0)
+        std::this_thread::yield();
+
+    NSA::Promise<void> gate;
+    NSA::Future<void> busy = kiosk.block(gate.get_future());
+
+    while (kiosk.currentJobs() != 0)
+        std::this_thread::yield();
+
+    // Block fills the job list before, DropOldest evicts the resume
+    // job after. Either way the coroutine resumes on this thread.
+    if (policy != NSA::Overflow::DropOldest)
+        kiosk.post(NSA::Job([]{}));
+
+    price.set_value(1);
+
+    if (policy == NSA::Overflow::DropOldest)
+        kiosk.post(NSA::Job([]{}));
+
+    const bool resumed = resold.ready() && resold.get() == 2;
+
+    gate.set_value();
+    busy.get();
+    kiosk.join();
+
+    return resumed;
+}
+
+int main(int argc, char **argv)
+{
+    Supplier supplier;
+    Vendor vendor(supplier);
+
+    supplier.detach(8);
+    vendor.detach(1);
+
+    std::vector<NSA::Service::Future<int>> sales;
+
+    for (int i = 0; i < 32; i++)
+        sales.push_back(vendor.sell(i));
+
+    for (int i = 0; i < 32; i++)
+    {
+        if (sales[i].get() != i + 1)
+        {
+            printf("Wrong result of sale %d\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("Sales in flight on a single worker: %d\n", vendor.maxInFlight);
+
+    if (vendor.resumedElsewhere != 0 || vendor.maxInFlight < 2)
+    {
+        printf("Coroutines did not resume on their service or blocked the worker\n");
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        vendor.restock().get();
+        printf("Exception did not pass through co_await\n");
+        return EXIT_FAILURE;
+    }
+    catch (const std::runtime_error &)
+    {}
+
+    vendor.join();
+    supplier.join();
+
+    if (!refused())
+    {
+        printf("Refused coroutine did not fail with Overloaded\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!stalled(NSA::Overflow::Block) || !stalled(NSA::Overflow::DropOldest))
+    {
+        printf("Coroutine did not resume past a full job list\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+#else
+
+int main(int argc, char **argv)
+{
+    printf("Compiler without coroutine support, skipped\n");
+    return EXIT_SUCCESS;
+}
+
+#endif
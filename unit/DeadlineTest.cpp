@@ -0,0 +1,149 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Service.hpp"
+
+/**
+ * @brief Service which records the order its jobs run in.
+ */
+class Recorder : public NSA::Service
+{
+public:
+    explicit Recorder(const NSA::QueueBackend backend = NSA::QueueBackend::Locked) :
+        Service("Recorder service", 0, backend)
+    {}
+
+    /**
+     * @brief Keeps the single worker busy until the gate opens.
+     */
+    Service::Future<void> block(NSA::Future<void> gate)
+    {
+        NSA_MAKE_PROMISE(Recorder::blockImp, void, gate);
+    }
+
+    Service::Future<int> record(const Deadline deadline, const int tag)
+    {
+        NSA_MAKE_DEADLINE_PROMISE(deadline, Recorder::recordImp, int, tag);
+    }
+
+    std::vector<int> order;
+
+private:
+    void blockImp(Service::Promise<void> promise, NSA::Future<void> gate)
+    {
+        gate.wait();
+        promise->set_value();
+    }
+
+    void recordImp(Service::Promise<int> promise, const int tag)
+    {
+        order.push_back(tag);
+        promise->set_value(tag);
+    }
+};
+
+static bool orderedQueue()
+{
+    NSA::BlockingQueue<int> queue(0, NSA::QueueBackend::Ordered);
+
+    if (queue.backend() != NSA::QueueBackend::Ordered)
+        return false;
+
+    for (const int value : {5, 1, 3, 1})
+        queue.push(value);
+
+    int value = 0;
+
+    for (const int expected : {1, 1, 3, 5})
+        if (!queue.tryPop(&value) || value != expected)
+            return false;
+
+    // Jobs cannot be compared, so they stay in FIFO order.
+    NSA::BlockingQueue<NSA::Job> jobs(0, NSA::QueueBackend::Ordered);
+
+    return jobs.backend() == NSA::QueueBackend::Locked;
+}
+
+int main(int argc, char **argv)
+{
+    if (!orderedQueue())
+    {
+        printf("Ordered queue failed\n");
+        return EXIT_FAILURE;
+    }
+
+    const NSA::Service::Deadline now = std::chrono::steady_clock::now();
+
+    // A job which is still queued at its deadline is shed.
+    Recorder shedding;
+    shedding.detach();
+
+    NSA::Promise<void> gate;
+    NSA::Future<void> blocked = shedding.block(gate.get_future());
+    NSA::Future<int> stale = shedding.record(now + std::chrono::milliseconds(5), 1);
+    NSA::Future<int> fresh = shedding.record(NSA::Service::Deadline::max(), 2);
+    bool dropped = false;
+
+    shedding.post([&dropped]{dropped = true;}, NSA::Priority::Normal, now);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    gate.set_value();
+
+    try
+    {
+        stale.get();
+        printf("Expired job was run\n");
+        return EXIT_FAILURE;
+    }
+    catch (const NSA::DeadlineExceeded &error)
+    {
+        printf("%s\n", error.what());
+    }
+
+    if (fresh.get() != 2 || dropped)
+        return EXIT_FAILURE;
+
+    blocked.get();
+    shedding.join();
+
+#if NSA_METRICS_ENABLED
+    if (shedding.metrics().shed != 2)
+    {
+        printf("Shed jobs were not counted\n");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    // The Ordered backend runs the earliest deadline first.
+    Recorder edf(NSA::QueueBackend::Ordered);
+    edf.detach();
+
+    NSA::Promise<void> edfGate;
+    std::vector<NSA::Future<int>> jobs;
+    blocked = edf.block(edfGate.get_future());
+
+    jobs.push_back(edf.record(NSA::Service::Deadline::max(), 6));
+
+    for (const int tag : {5, 3, 1, 4, 2})
+        jobs.push_back(edf.record(now + std::chrono::seconds(10 + tag), tag));
+
+    edfGate.set_value();
+
+    for (NSA::Future<int> &job : jobs)
+        job.get();
+
+    edf.join();
+
+    for (std::size_t i = 0; i < edf.order.size(); i++)
+    {
+        if (edf.order[i] != static_cast<int>(i) + 1)
+        {
+            printf("Jobs did not run earliest deadline first\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
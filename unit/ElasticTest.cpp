@@ -0,0 +1,97 @@
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Service.hpp"
+
+/**
+ * @brief Service whose jobs take a few milliseconds each.
+ */
+class Slow : public NSA::Service
+{
+public:
+    Slow() : Service("Slow service"), served(0)
+    {}
+
+    Service::Future<int> serve(const int value)
+    {
+        NSA_MAKE_PROMISE(Slow::serveImp, int, value);
+    }
+
+    std::atomic<int> served;
+
+private:
+    void serveImp(Service::Promise<int> promise, const int value)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        served++;
+        promise->set_value(value);
+    }
+};
+
+/**
+ * @brief Waits until the service runs the given amount of workers.
+ * @return The workers seen last.
+ */
+static std::size_t awaitWorkers(const Slow &service, const std::size_t workers)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    while (service.currentWorkers() != workers && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    return service.currentWorkers();
+}
+
+int main(int argc, char **argv)
+{
+    NSA::Elasticity elasticity;
+    elasticity.minWorkers = 1;
+    elasticity.maxWorkers = 3;
+    elasticity.queueDepth = 4;
+    elasticity.sustain = std::chrono::milliseconds(20);
+    elasticity.coolDown = std::chrono::milliseconds(100);
+
+    Slow service;
+    service.detach(elasticity);
+
+    if (service.currentWorkers() != 1)
+        return EXIT_FAILURE;
+
+    // The rush adds workers up to the maximum.
+    for (int round = 0; round < 2; round++)
+    {
+        std::vector<NSA::Future<int>> futures;
+        std::size_t peak = 0;
+
+        for (int i = 0; i < 200; i++)
+            futures.push_back(service.serve(i));
+
+        for (int i = 0; i < 200; i++)
+        {
+            if (futures[i].get() != i)
+                return EXIT_FAILURE;
+
+            peak = std::max(peak, service.currentWorkers());
+        }
+
+        printf("Round %d peaked at %zu workers\n", round, peak);
+
+        if (peak != elasticity.maxWorkers)
+            return EXIT_FAILURE;
+
+        // Idle workers retire after the cool down.
+        if (awaitWorkers(service, elasticity.minWorkers) != elasticity.minWorkers)
+        {
+            printf("Idle workers did not retire\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    service.join();
+
+    return service.served == 400 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,107 @@
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <vector>
+#include "Service.hpp"
+
+#define SERVICES 8
+#define JOBS     500
+
+/**
+ * @brief A service which records the order and concurrency of its jobs.
+ */
+class Recorder : public NSA::Service
+{
+public:
+    Recorder() : Service("Recorder service", 32), running(0), maxRunning(0), ordered(true), last(-1)
+    {
+        jobTimeOut(std::chrono::milliseconds(60000));
+    }
+
+    Service::Future<int> record(const int sequence)
+    {
+        NSA_MAKE_PROMISE(Recorder::recordImp, int, sequence);
+    }
+
+    std::atomic<int> running;
+    std::atomic<int> maxRunning;
+    std::atomic<bool> ordered;
+
+private:
+    void recordImp(Service::Promise<int> promise, const int sequence)
+    {
+        const int now = ++running;
+        int seen = maxRunning;
+
+        while (now > seen && !maxRunning.compare_exchange_weak(seen, now));
+
+        if (sequence != last + 1)
+            ordered = false;
+
+        last = sequence;
+        std::this_thread::yield();
+        running--;
+
+        promise->set_value(sequence);
+    }
+
+    std::atomic<int> last;
+};
+
+int main(int argc, char **argv)
+{
+    NSA::Executor executor(4);
+    std::vector<Recorder> recorders(SERVICES);
+
+    for (Recorder &recorder : recorders)
+        recorder.attach(executor);
+
+    // Feed all services from several threads at once.
+    std::vector<std::thread> clients;
+
+    for (int s = 0; s < SERVICES; s++)
+        clients.push_back(std::thread([&recorders, s]()
+        {
+            NSA::Service::Future<int> future;
+
+            for (int i = 0; i < JOBS; i++)
+                future = recorders[s].record(i);
+
+            future->get();
+        }));
+
+    for (std::thread &client : clients)
+        client.join();
+
+    for (Recorder &recorder : recorders)
+        recorder.join();
+
+    printf("%d services on %zu executor threads\n", SERVICES, executor.threads());
+
+    for (Recorder &recorder : recorders)
+    {
+        if (recorder.totalJobs() != JOBS || recorder.currentJobs() != 0)
+        {
+            printf("Jobs got lost\n");
+            return EXIT_FAILURE;
+        }
+
+        if (!recorder.ordered || recorder.maxRunning != 1)
+        {
+            printf("A service with one worker ran out of order or in parallel\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // A higher concurrency limit lets jobs of one service run in parallel.
+    Recorder parallel;
+    parallel.attach(executor, 4);
+
+    for (int i = 0; i < JOBS; i++)
+        parallel.record(i);
+
+    parallel.join();
+    printf("Most parallel jobs with a limit of 4: %d\n", parallel.maxRunning.load());
+
+    return parallel.totalJobs() == JOBS && parallel.maxRunning <= 4 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,205 @@
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include "BlockingQueue.hpp"
+#include "Job.hpp"
+#include "Service.hpp"
+
+/// Counts every allocation of the process.
+static std::atomic<std::size_t> allocations(0);
+
+void *operator new(std::size_t size)
+{
+    allocations++;
+
+    if (void *memory = std::malloc(size))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+struct Order
+{
+    void serve(std::shared_ptr<int> promise, const std::string order, int scoops)
+    {
+        *promise += scoops + static_cast<int>(order.size());
+    }
+};
+
+/**
+ * @brief Submits jobs through a queue and counts the allocations.
+ * @details The jobs look like the ones created by NSA_MAKE_PROMISE: a
+ *          bound member function with a promise and a few arguments.
+ *
+ * @param backend The backend under test.
+ * @return The amount of allocations in the steady state.
+ */
+std::size_t allocationsPerRun(const NSA::QueueBackend backend)
+{
+    NSA::BlockingQueue<NSA::Job> queue(64, backend);
+    std::shared_ptr<int> promise(new int(0));
+    Order order;
+    NSA::Job job;
+
+    auto submit = [&](const int scoops)
+    {
+        auto bound = std::bind(&Order::serve, &order, std::placeholders::_1, std::string("Vanille"), scoops);
+
+        queue.emplace(std::chrono::milliseconds(30), [bound, promise]() mutable
+        {
+            bound(promise);
+        });
+    };
+
+    // Warm up, so the queue reached its working size.
+    for (int i = 0; i < 64; i++)
+        submit(i);
+
+    while (!queue.empty())
+    {
+        queue.pop(&job);
+        job();
+    }
+
+    const std::size_t before = allocations;
+
+    for (int i = 0; i < 1000; i++)
+    {
+        submit(i);
+        queue.pop(&job);
+        job();
+    }
+
+    return allocations - before;
+}
+
+class Parlor : public NSA::Service
+{
+public:
+    Parlor() : Service("Parlor service")
+    {}
+
+    Service::Future<int> serve(const std::string order, const int scoops)
+    {
+        NSA_MAKE_PROMISE(Parlor::serveImp, int, order, scoops);
+    }
+
+private:
+    void serveImp(Service::Promise<int> promise, const std::string order, const int scoops)
+    {
+        promise->set_value(scoops + static_cast<int>(order.size()));
+    }
+};
+
+/**
+ * @brief Submits jobs with NSA_MAKE_PROMISE to a running service and
+ *        counts the allocations.
+ * @return The amount of allocations in the steady state.
+ */
+std::size_t allocationsPerPromise()
+{
+    Parlor parlor;
+    parlor.detach();
+
+    // Warm up, so the job list and the promise pool reached their
+    // working size.
+    for (int i = 0; i < 64; i++)
+        parlor.serve("Vanille", i).get();
+
+    const std::size_t before = allocations;
+    bool served = true;
+
+    for (int i = 0; i < 1000; i++)
+        served = parlor.serve("Vanille", i).get() == i + 7 && served;
+
+    const std::size_t count = allocations - before;
+    parlor.join();
+
+    return served ? count : 1;
+}
+
+int main(int argc, char **argv)
+{
+    printf("sizeof(Job) is %zu bytes, %zu bytes inline\n", sizeof(NSA::Job), NSA::Job::InlineSize);
+
+    const std::size_t locked = allocationsPerRun(NSA::QueueBackend::Locked);
+    const std::size_t ring = allocationsPerRun(NSA::QueueBackend::Ring);
+
+    printf("Allocations for 1000 jobs. Locked: %zu, Ring: %zu\n", locked, ring);
+
+    if (locked != 0 || ring != 0)
+        return EXIT_FAILURE;
+
+    const std::size_t promised = allocationsPerPromise();
+    printf("Allocations for 1000 promised jobs: %zu\n", promised);
+
+    if (promised != 0)
+        return EXIT_FAILURE;
+
+    // Move-only callables are accepted.
+    std::unique_ptr<int> owned(new int(41));
+    int result = 0;
+    NSA::Job moveOnly([owned = std::move(owned), &result]{result = *owned + 1;});
+    NSA::Job moved(std::move(moveOnly));
+    moved();
+
+    if (result != 42 || moveOnly)
+    {
+        printf("Move-only job did not run\n");
+        return EXIT_FAILURE;
+    }
+
+    // Large callables still work, they just live on the heap.
+    char large[NSA::Job::InlineSize + 1] = {7};
+    const std::size_t before = allocations;
+    NSA::Job heap([large, &result]{result = large[0];});
+    heap();
+
+    if (result != 7 || allocations - before != 1)
+    {
+        printf("Large job was not stored on the heap\n");
+        return EXIT_FAILURE;
+    }
+
+    // Cancelling hands the error to callables which take one.
+    struct Cancellable
+    {
+        std::exception_ptr *reason;
+
+        void operator()() {}
+
+        void cancel(std::exception_ptr error)
+        {
+            *reason = error;
+        }
+    };
+
+    std::exception_ptr reason;
+    NSA::Job cancelled(Cancellable{&reason});
+    cancelled.cancel(std::make_exception_ptr(std::string("late")));
+
+    NSA::Job plain([&result]{result = 0;});
+    plain.cancel(std::make_exception_ptr(std::string("late")));
+
+    if (!reason || cancelled || plain || result != 7)
+    {
+        printf("Cancelled job was not dropped\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
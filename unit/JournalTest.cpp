@@ -0,0 +1,333 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "BlockingQueue.hpp"
+
+#define PRODUCERS 4
+#define ELEMENTS 2000
+
+/**
+ * @brief Creates an empty directory for a journal.
+ */
+static std::string directory()
+{
+    char path[] = "/tmp/nsa-journal-XXXXXX";
+    return mkdtemp(path) ? path : "";
+}
+
+/**
+ * @brief Removes the journal files and the directory.
+ */
+static void remove(const std::string &path, const std::size_t segments)
+{
+    unlink((path + "/head").c_str());
+
+    for (std::size_t i = 0; i < segments; i++)
+        unlink((path + "/segment-" + std::to_string(i)).c_str());
+
+    rmdir(path.c_str());
+}
+
+/**
+ * @brief Pops count elements and checks they continue at first.
+ */
+static bool drain(NSA::BlockingQueue<int> &queue, int first, const int count)
+{
+    int item = 0;
+
+    for (int i = 0; i < count; i++)
+        if (!queue.tryPop(&item) || item != first++)
+            return false;
+
+    return !queue.tryPop(&item);
+}
+
+/**
+ * @brief Unpopped elements come back after a restart, in order.
+ */
+static bool restart(const std::string &path)
+{
+    {
+        NSA::BlockingQueue<int> queue(1000, NSA::QueueBackend::Ring);
+
+        if (!queue.journal(path) || queue.backend() != NSA::QueueBackend::Locked || !queue.empty())
+            return false;
+
+        for (int i = 0; i < 100; i++)
+            queue.push(i);
+
+        int item = 0;
+
+        for (int i = 0; i < 30; i++)
+            queue.pop(&item);
+    }
+
+    NSA::BlockingQueue<int> queue(1000);
+
+    if (!queue.journal(path) || queue.size() != 70)
+    {
+        printf("%zu elements replayed instead of 70\n", queue.size());
+        return false;
+    }
+
+    return drain(queue, 30, 70);
+}
+
+/**
+ * @brief A process which dies without any cleanup loses nothing.
+ */
+static bool crash(const std::string &path)
+{
+    const pid_t child = fork();
+
+    if (child == 0)
+    {
+        NSA::BlockingQueue<int> queue;
+
+        if (!queue.journal(path))
+            _exit(EXIT_FAILURE);
+
+        int item = 0;
+
+        for (int i = 0; i < 500; i++)
+            queue.push(i);
+
+        for (int i = 0; i < 100; i++)
+            queue.pop(&item);
+
+        _exit(EXIT_SUCCESS);
+    }
+
+    int status = 0;
+
+    if (child < 0 || waitpid(child, &status, 0) != child || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        return false;
+
+    NSA::BlockingQueue<int> queue;
+
+    return queue.journal(path) && queue.size() == 400 && drain(queue, 100, 400);
+}
+
+/**
+ * @brief Runs the segment ring full, drains it and goes around several
+ *        times, with a restart on every round.
+ */
+static bool wrap(const std::string &path)
+{
+    NSA::JournalOptions options;
+    options.segmentSize = 4096;
+    options.segments = 3;
+    options.sync = NSA::JournalSync::None;
+
+    int next = 0;
+    int expected = 0;
+
+    for (int round = 0; round < 10; round++)
+    {
+        NSA::BlockingQueue<int> queue;
+
+        if (!queue.journal(path, options))
+            return false;
+
+        int item = 0;
+
+        // Whatever the last round left behind comes first.
+        while (queue.tryPop(&item))
+            if (item != expected++)
+                return false;
+
+        std::size_t pushed = 0;
+
+        while (queue.tryPush(int(next)))
+        {
+            next++;
+            pushed++;
+        }
+
+        // At least a whole segment is free, but never more than the ring.
+        if (pushed < 4096 / 24 || pushed > 3 * 4096 / 24)
+        {
+            printf("%zu elements fit into the ring\n", pushed);
+            return false;
+        }
+
+        // Pop all but a few, which carry over.
+        for (std::size_t i = 0; i + 5 < pushed; i++)
+            if (!queue.tryPop(&item) || item != expected++)
+                return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief A torn record ends the journal, the records before it survive.
+ */
+static bool torn(const std::string &path)
+{
+    NSA::JournalOptions options;
+    options.segments = 1;
+    options.segmentSize = 4096;
+
+    {
+        NSA::BlockingQueue<std::string> queue;
+
+        if (!queue.journal(path, options))
+            return false;
+
+        for (int i = 0; i < 10; i++)
+            queue.push("element" + std::to_string(i));
+    }
+
+    // Each record is a 16 byte header and 8 bytes of payload, behind the
+    // 16 byte segment header. Flip a byte of the last payload.
+    const int file = open((path + "/segment-0").c_str(), O_RDWR);
+    const off_t offset = 16 + 9 * 24 + 16;
+    char byte = 0;
+
+    if (file < 0 || pread(file, &byte, 1, offset) != 1)
+        return false;
+
+    byte ^= 0x20;
+
+    if (pwrite(file, &byte, 1, offset) != 1)
+        return false;
+
+    close(file);
+
+    NSA::BlockingQueue<std::string> queue;
+
+    if (!queue.journal(path, options) || queue.size() != 9)
+    {
+        printf("%zu elements survived the torn record\n", queue.size());
+        return false;
+    }
+
+    std::string item;
+
+    for (int i = 0; i < 9; i++)
+        if (!queue.tryPop(&item) || item != "element" + std::to_string(i))
+            return false;
+
+    // Appends go on where the journal ended.
+    queue.push("after");
+
+    NSA::BlockingQueue<int> numbers(16, NSA::QueueBackend::Ring);
+
+    // A record the codec cannot decode fails the journal, and the queue
+    // keeps its backend.
+    return !numbers.journal(path, options) && numbers.empty() && numbers.backend() == NSA::QueueBackend::Ring;
+}
+
+/**
+ * @brief Empty elements are records of their own, and the records after
+ *        them survive a restart.
+ */
+static bool empty(const std::string &path)
+{
+    {
+        NSA::BlockingQueue<std::string> queue;
+
+        if (!queue.journal(path))
+            return false;
+
+        queue.push("a");
+        queue.push("");
+        queue.push("c");
+    }
+
+    NSA::BlockingQueue<std::string> queue;
+
+    if (!queue.journal(path) || queue.size() != 3)
+    {
+        printf("%zu elements replayed instead of 3\n", queue.size());
+        return false;
+    }
+
+    std::string item;
+
+    return queue.tryPop(&item) && item == "a" && queue.tryPop(&item) && item.empty()
+        && queue.tryPop(&item) && item == "c";
+}
+
+/**
+ * @brief Producers share the syncs of a group commit, and nothing is
+ *        left once everything was popped.
+ */
+static bool group(const std::string &path)
+{
+    {
+        NSA::BlockingQueue<int> queue(256);
+
+        if (!queue.journal(path))
+            return false;
+
+        std::vector<std::thread> producers;
+
+        for (int p = 0; p < PRODUCERS; p++)
+            producers.emplace_back([&queue, p]
+            {
+                for (int i = 0; i < ELEMENTS; i++)
+                    while (!queue.push(p * ELEMENTS + i, std::chrono::milliseconds(1000)))
+                    {}
+            });
+
+        std::vector<int> last(PRODUCERS, -1);
+        int item = 0;
+
+        for (int i = 0; i < PRODUCERS * ELEMENTS; i++)
+        {
+            if (!queue.pop(&item))
+                return false;
+
+            // Each producer keeps its order.
+            if (item % ELEMENTS <= last[item / ELEMENTS])
+                return false;
+
+            last[item / ELEMENTS] = item % ELEMENTS;
+        }
+
+        for (std::thread &producer : producers)
+            producer.join();
+    }
+
+    NSA::BlockingQueue<int> queue;
+
+    return queue.journal(path) && queue.empty();
+}
+
+int main(int argc, char **argv)
+{
+    struct Case
+    {
+        const char *name;
+        bool (*run)(const std::string &);
+    };
+
+    const Case cases[] = {{"restart", restart}, {"crash", crash}, {"wrap", wrap}, {"torn", torn},
+        {"empty", empty}, {"group", group}};
+
+    for (const Case &test : cases)
+    {
+        const std::string path = directory();
+
+        if (path.empty())
+            return EXIT_FAILURE;
+
+        const bool passed = test.run(path);
+        remove(path, 4);
+
+        if (!passed)
+        {
+            printf("Journal %s failed\n", test.name);
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,139 @@
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "Service.hpp"
+
+/**
+ * @brief Last hop, which can be blocked.
+ */
+class Sink : public NSA::Service
+{
+public:
+    Sink() : Service("Sink service", 2), received(0)
+    {
+        // Credits keep every forward from waiting for room.
+        jobTimeOut(std::chrono::milliseconds(5));
+    }
+
+    Service::Future<void> block(NSA::Future<void> gate)
+    {
+        NSA_MAKE_PROMISE(Sink::blockImp, void, gate);
+    }
+
+    Service::Future<void> receive(const int value)
+    {
+        NSA_MAKE_PROMISE(Sink::receiveImp, void, value);
+    }
+
+    std::atomic<int> received;
+
+private:
+    void blockImp(Service::Promise<void> promise, NSA::Future<void> gate)
+    {
+        gate.wait();
+        promise->set_value();
+    }
+
+    void receiveImp(Service::Promise<void> promise, const int)
+    {
+        received++;
+        promise->set_value();
+    }
+};
+
+/**
+ * @brief First hop, which forwards every job to the sink.
+ */
+class Relay : public NSA::Service
+{
+public:
+    Relay(Sink &sink) : Service("Relay service"), inside(0), sink(sink)
+    {
+        link(sink);
+    }
+
+    Service::Future<void> relay(const int value)
+    {
+        NSA_MAKE_PROMISE(Relay::relayImp, void, value);
+    }
+
+    Service::Future<void> keep(const int value)
+    {
+        NSA_MAKE_PROMISE(Relay::keepImp, void, value);
+    }
+
+    std::atomic<int> inside;   ///< Jobs running right now.
+
+private:
+    void relayImp(Service::Promise<void> promise, const int value)
+    {
+        inside++;
+        sink.receive(value);
+        inside--;
+        promise->set_value();
+    }
+
+    void keepImp(Service::Promise<void> promise, const int)
+    {
+        promise->set_value();
+    }
+
+    Sink &sink;
+};
+
+int main(int argc, char **argv)
+{
+    Sink sink;
+    Relay relay(sink);
+
+    sink.detach();
+    relay.detach();
+
+    NSA::Promise<void> gate;
+    NSA::Future<void> blocked = sink.block(gate.get_future());
+
+    while (sink.currentJobs() != 0)
+        std::this_thread::yield();
+
+    // Jobs which do not forward hand their credit back.
+    for (int i = 0; i < 100; i++)
+        relay.keep(i).get();
+
+    for (int i = 0; i < 10; i++)
+        relay.relay(i);
+
+    // The sink takes two jobs, the relay has to hold back the others.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    while (sink.currentJobs() != 2 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::yield();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    printf("Relay holds %zu jobs, sink holds %zu jobs, %d jobs blocked\n", relay.currentJobs(),
+        sink.currentJobs(), relay.inside.load());
+
+    if (relay.currentJobs() != 8 || sink.currentJobs() != 2 || relay.inside != 0)
+        return EXIT_FAILURE;
+
+    gate.set_value();
+    blocked.get();
+
+    while (sink.received != 10 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::yield();
+
+    relay.join();
+    sink.join();
+
+#if NSA_METRICS_ENABLED
+    if (sink.metrics().timeouts != 0)
+    {
+        printf("A forward waited for room\n");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    return sink.received == 10 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,174 @@
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Service.hpp"
+
+class Sleeper : public NSA::Service
+{
+public:
+    Sleeper(const std::size_t jobLimit = 0) : Service("Sleeper service", jobLimit) {}
+
+    Service::Future<void> nap(const int milliseconds)
+    {
+        NSA_MAKE_PROMISE(Sleeper::napImp, void, milliseconds);
+    }
+
+    /**
+     * @brief Naps once as many jobs arrived as there are workers, so
+     *        every worker runs one of them.
+     */
+    Service::Future<void> meet(std::atomic<int> *arrived, const int workers, const int milliseconds)
+    {
+        NSA_MAKE_PROMISE(Sleeper::meetImp, void, arrived, workers, milliseconds);
+    }
+
+private:
+    void napImp(Service::Promise<void> promise, const int milliseconds)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+        promise->set_value();
+    }
+
+    void meetImp(Service::Promise<void> promise, std::atomic<int> *arrived, const int workers,
+        const int milliseconds)
+    {
+        arrived->fetch_add(1);
+
+        while (arrived->load() < workers)
+            std::this_thread::yield();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+        promise->set_value();
+    }
+};
+
+static bool checkHistogram()
+{
+    for (std::uint64_t value = 0; value < (std::uint64_t(1) << 40); value = value * 3 / 2 + 1)
+    {
+        const std::int64_t highest = NSA::LatencyHistogram::highestOf(NSA::LatencyHistogram::bucketOf(value));
+
+        // Every bucket is at most 1/16 wide relative to its values.
+        if (highest < static_cast<std::int64_t>(value) ||
+            highest - static_cast<std::int64_t>(value) > static_cast<std::int64_t>(value / 16))
+        {
+            printf("Value %llu lands in a bucket up to %lld\n",
+                static_cast<unsigned long long>(value), static_cast<long long>(highest));
+            return false;
+        }
+    }
+
+    NSA::LatencyHistogram histogram;
+
+    for (std::int64_t value = 1; value <= 100000; value++)
+        histogram.record(value);
+
+    const NSA::HistogramSnapshot snapshot = histogram.snapshot();
+    const std::int64_t median = snapshot.percentile(50.0);
+    const std::int64_t tail = snapshot.percentile(99.9);
+
+    printf("Histogram p50 %lld p99.9 %lld max %lld\n", static_cast<long long>(median),
+        static_cast<long long>(tail), static_cast<long long>(snapshot.max));
+
+    return snapshot.count == 100000 && snapshot.max == 100000 &&
+        median >= 50000 && median <= 53125 && tail >= 99900 && tail <= 100000;
+}
+
+int main(int argc, char **argv)
+{
+    if (!checkHistogram())
+        return EXIT_FAILURE;
+
+    Sleeper sleeper;
+    sleeper.detach(2);
+
+    // Sample concurrently while the workers record.
+    std::atomic<bool> sampling(true);
+    std::thread sampler([&]
+    {
+        while (sampling)
+            sleeper.metrics();
+    });
+
+    std::vector<NSA::Future<void>> naps;
+
+    for (int i = 0; i < 20; i++)
+        naps.push_back(sleeper.nap(1));
+
+    // Each worker is busy for at least a millisecond.
+    std::atomic<int> arrived(0);
+
+    for (int i = 0; i < 2; i++)
+        naps.push_back(sleeper.meet(&arrived, 2, 1));
+
+    for (NSA::Future<void> &nap : naps)
+        nap.get();
+
+    sampling = false;
+    sampler.join();
+    sleeper.join();
+
+    // Rejected by the stopped service.
+    sleeper.nap(1);
+
+    const NSA::MetricsSnapshot metrics = sleeper.metrics();
+
+#if NSA_METRICS_ENABLED
+    std::uint64_t jobs = 0;
+
+    for (const NSA::WorkerSnapshot &worker : metrics.workers)
+        jobs += worker.jobs;
+
+    printf("Queued p50 %lld ns, running p50 %lld ns, response p99 %lld ns, high water %zu, "
+        "%zu contended locks waited %lld ns\n",
+        static_cast<long long>(metrics.queued.percentile(50.0)),
+        static_cast<long long>(metrics.running.percentile(50.0)),
+        static_cast<long long>(metrics.response.percentile(99.0)), metrics.highWater,
+        metrics.contentions, static_cast<long long>(metrics.lockWait.count()));
+
+    if (metrics.workers.size() != 2 || jobs != 22 || metrics.response.count != 22 ||
+        metrics.running.percentile(50.0) < 1000000 || metrics.highWater < 1 ||
+        metrics.workers[0].busy.count() < 1000000 || metrics.workers[1].busy.count() < 1000000 ||
+        metrics.rejections != 1 || (metrics.lockWait.count() != 0 && metrics.contentions == 0))
+    {
+        printf("Wrong service metrics\n");
+        return EXIT_FAILURE;
+    }
+
+    // A full job list times out.
+    Sleeper narrow(1);
+    narrow.jobTimeOut(std::chrono::milliseconds(1));
+    narrow.detach();
+
+    NSA::Future<void> busy = narrow.nap(50);
+    NSA::Future<void> queued;
+
+    // Wait until the worker took the first job, so the second one
+    // fills the job list and the third one times out.
+    while (narrow.currentJobs() != 0)
+        std::this_thread::yield();
+
+    queued = narrow.nap(1);
+    narrow.nap(1);
+    busy.get();
+    queued.get();
+    narrow.join();
+
+    if (narrow.metrics().timeouts != 1)
+    {
+        printf("Timeout was not counted\n");
+        return EXIT_FAILURE;
+    }
+#else
+    if (!metrics.workers.empty() || metrics.response.count != 0 || metrics.rejections != 0)
+    {
+        printf("Instrumentation was not compiled out\n");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    return EXIT_SUCCESS;
+}
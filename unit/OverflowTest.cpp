@@ -0,0 +1,192 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Service.hpp"
+
+/**
+ * @brief Service with a job list of two jobs.
+ */
+class Narrow : public NSA::Service
+{
+public:
+    explicit Narrow(const NSA::Overflow policy, const NSA::QueueBackend backend = NSA::QueueBackend::Locked) :
+        Service("Narrow service", 2, backend)
+    {
+        jobOverflow(policy);
+        jobTimeOut(std::chrono::milliseconds(1000));
+    }
+
+    /**
+     * @brief Keeps the single worker busy until the gate opens.
+     */
+    Service::Future<void> block(NSA::Future<void> gate)
+    {
+        NSA_MAKE_PROMISE(Narrow::blockImp, void, gate);
+    }
+
+    Service::Future<int> echo(const int value)
+    {
+        NSA_MAKE_PROMISE(Narrow::echoImp, int, value);
+    }
+
+    Service::Future<int> echo(const int value, const Deadline deadline)
+    {
+        NSA_MAKE_DEADLINE_PROMISE(deadline, Narrow::echoImp, int, value);
+    }
+
+private:
+    void blockImp(Service::Promise<void> promise, NSA::Future<void> gate)
+    {
+        gate.wait();
+        promise->set_value();
+    }
+
+    void echoImp(Service::Promise<int> promise, const int value)
+    {
+        promise->set_value(value);
+    }
+};
+
+/**
+ * @brief Check to see if a future already failed with an Overloaded error.
+ */
+static bool overloaded(NSA::Future<int> &future)
+{
+    if (future->wait_for(std::chrono::milliseconds(0)) != std::future_status::ready)
+        return false;
+
+    try
+    {
+        future.get();
+    }
+    catch (const NSA::Overloaded &)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Fills the job list behind a blocked worker and submits one
+ *        more job.
+ * @return The futures of the three jobs, in submission order.
+ */
+static std::vector<NSA::Future<int>> overfill(const NSA::Overflow policy, std::chrono::nanoseconds &blocked,
+    std::size_t &overflows)
+{
+    Narrow service(policy);
+    service.detach();
+
+    NSA::Promise<void> gate;
+    NSA::Future<void> busy = service.block(gate.get_future());
+
+    while (service.currentJobs() != 0)
+        std::this_thread::yield();
+
+    std::vector<NSA::Future<int>> futures;
+    futures.push_back(service.echo(1));
+    futures.push_back(service.echo(2));
+
+    const auto start = std::chrono::steady_clock::now();
+    futures.push_back(service.echo(3));
+    blocked = std::chrono::steady_clock::now() - start;
+
+    gate.set_value();
+    busy.get();
+    service.join();
+
+    overflows = service.metrics().overflows;
+
+    return futures;
+}
+
+/**
+ * @brief DropOldest on the Ordered backend fails the job queued first,
+ *        not the one with the earliest deadline.
+ */
+static bool ordered()
+{
+    Narrow service(NSA::Overflow::DropOldest, NSA::QueueBackend::Ordered);
+    service.detach();
+
+    NSA::Promise<void> gate;
+    NSA::Future<void> busy = service.block(gate.get_future());
+
+    while (service.currentJobs() != 0)
+        std::this_thread::yield();
+
+    const auto now = std::chrono::steady_clock::now();
+    NSA::Future<int> oldest = service.echo(1, now + std::chrono::seconds(60));
+    NSA::Future<int> urgent = service.echo(2, now + std::chrono::seconds(30));
+    NSA::Future<int> newest = service.echo(3, now + std::chrono::seconds(45));
+
+    gate.set_value();
+    busy.get();
+    service.join();
+
+    return overloaded(oldest) && urgent.get() == 2 && newest.get() == 3;
+}
+
+int main(int argc, char **argv)
+{
+    std::chrono::nanoseconds blocked;
+    std::size_t overflows = 0;
+
+    // Reject fails the new job without waiting for the time out.
+    std::vector<NSA::Future<int>> futures = overfill(NSA::Overflow::Reject, blocked, overflows);
+
+    if (!overloaded(futures[2]) || futures[0].get() != 1 || futures[1].get() != 2 ||
+        blocked > std::chrono::milliseconds(100))
+    {
+        printf("Reject policy failed\n");
+        return EXIT_FAILURE;
+    }
+
+    // DropOldest fails the first queued job and runs the new one.
+    futures = overfill(NSA::Overflow::DropOldest, blocked, overflows);
+
+    if (!overloaded(futures[0]) || futures[1].get() != 2 || futures[2].get() != 3 ||
+        blocked > std::chrono::milliseconds(100))
+    {
+        printf("DropOldest policy failed\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!ordered())
+    {
+        printf("DropOldest policy failed on the Ordered backend\n");
+        return EXIT_FAILURE;
+    }
+
+#if NSA_METRICS_ENABLED
+    if (overflows != 1)
+    {
+        printf("Evicted job was not counted\n");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    // Block waits for the time out, then fails the new job as well.
+    futures = overfill(NSA::Overflow::Block, blocked, overflows);
+
+    printf("Blocked for %lld ms\n",
+        static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(blocked).count()));
+
+    if (!overloaded(futures[2]) || blocked < std::chrono::milliseconds(900))
+    {
+        printf("Block policy failed\n");
+        return EXIT_FAILURE;
+    }
+
+    // A refused post hands the job back.
+    Narrow stopped(NSA::Overflow::Reject);
+    NSA::Job job([]{});
+
+    if (stopped.post(std::move(job)) || !job)
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
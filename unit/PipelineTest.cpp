@@ -0,0 +1,278 @@
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Pipeline.hpp"
+
+#define ELEMENTS 1000
+
+/**
+ * @brief Every stage keeps the output of the stage before.
+ */
+static bool typed()
+{
+    NSA::Service parse("Parse service"), square("Square service"), print("Print service");
+    parse.detach();
+    square.detach(2);
+    print.detach();
+
+    auto line = NSA::Pipeline<std::string>()
+        .stage(parse, [](std::string text){return std::stoi(text);})
+        .stage(square, [](int value){return static_cast<long>(value) * value;}, 8)
+        .stage(print, [](long value){return std::to_string(value);});
+
+    std::vector<NSA::Future<std::string>> futures;
+
+    for (int i = 0; i < ELEMENTS; i++)
+        futures.push_back(line.push(std::to_string(i)));
+
+    for (int i = 0; i < ELEMENTS; i++)
+    {
+        if (futures[i].get() != std::to_string(static_cast<long>(i) * i))
+            return false;
+    }
+
+    parse.join();
+    square.join();
+    print.join();
+
+    return line.queuedHops() == 3 * ELEMENTS && line.fusedHops() == 0;
+}
+
+/**
+ * @brief Idle inline stages run on the worker of the first stage.
+ */
+static bool fused()
+{
+    NSA::Service first("First service"), second("Second service"), third("Third service");
+    first.detach();
+    second.detach();
+    third.detach();
+
+    std::atomic<std::size_t> apart(0);
+
+    auto line = NSA::Pipeline<int>()
+        .stage(first, [](int value){return std::make_pair(value, std::this_thread::get_id());})
+        .stage(second, [](std::pair<int, std::thread::id> value){return value;}, 0, NSA::Fusion::Inline)
+        .stage(third, [&apart](std::pair<int, std::thread::id> value)
+        {
+            if (value.second != std::this_thread::get_id())
+                apart++;
+        }, 0, NSA::Fusion::Inline);
+
+    // One element at a time, so the later stages always find their service idle.
+    for (int i = 0; i < ELEMENTS; i++)
+        line.push(i).get();
+
+    first.join();
+    second.join();
+    third.join();
+
+    printf("%zu fused, %zu queued\n", line.fusedHops(), line.queuedHops());
+
+    return apart == 0 && line.fusedHops() == 2 * ELEMENTS && line.queuedHops() == ELEMENTS;
+}
+
+/**
+ * @brief An inline stage does not run beside a busy worker of its
+ *        service, even with an empty job list.
+ */
+static bool busy()
+{
+    NSA::Service first("First service"), second("Second service");
+    first.detach();
+    second.detach();
+
+    std::atomic<bool> blocking(false);
+    NSA::Promise<void> gate;
+    NSA::Future<void> opened = gate.get_future();
+
+    second.post(NSA::Job([&blocking, opened]() mutable
+    {
+        blocking = true;
+        opened.wait();
+        blocking = false;
+    }));
+
+    while (!blocking)
+        std::this_thread::yield();
+
+    std::atomic<int> overlaps(0);
+
+    auto line = NSA::Pipeline<int>()
+        .stage(first, [](int value){return value;})
+        .stage(second, [&blocking, &overlaps](int value)
+        {
+            if (blocking)
+                overlaps++;
+
+            return value;
+        }, 0, NSA::Fusion::Inline);
+
+    NSA::Future<int> future = line.push(1);
+    const bool waited = future->wait_for(std::chrono::milliseconds(20)) == std::future_status::timeout;
+
+    gate.set_value();
+
+    const bool queued = future.get() == 1 && overlaps == 0 && line.fusedHops() == 0;
+
+    first.join();
+    second.join();
+
+    return waited && queued;
+}
+
+/**
+ * @brief A stage with a capacity of one runs one element at a time,
+ *        even with several workers.
+ */
+static bool capacity()
+{
+    NSA::Service source("Source service"), slow("Slow service");
+    source.detach(2);
+    slow.detach(4);
+
+    std::atomic<int> inside(0);
+    std::atomic<int> peak(0);
+
+    auto line = NSA::Pipeline<int>()
+        .stage(source, [](int value){return value;})
+        .stage(slow, [&inside, &peak](int value)
+        {
+            const int now = ++inside;
+            int seen = peak;
+
+            while (now > seen && !peak.compare_exchange_weak(seen, now))
+            {}
+
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            inside--;
+
+            return value;
+        }, 1);
+
+    std::vector<NSA::Future<int>> futures;
+
+    for (int i = 0; i < 100; i++)
+        futures.push_back(line.push(i));
+
+    for (NSA::Future<int> &future : futures)
+        future.get();
+
+    source.join();
+    slow.join();
+
+    return peak == 1;
+}
+
+/**
+ * @brief A full stage which does not move fails the next element after
+ *        the time out, instead of holding the worker before it.
+ */
+static bool stalled()
+{
+    NSA::Service source("Source service"), stuck("Stuck service");
+    stuck.jobTimeOut(std::chrono::milliseconds(50));
+    source.detach();
+    stuck.detach();
+
+    NSA::Promise<void> gate;
+    NSA::Future<void> opened = gate.get_future();
+
+    auto line = NSA::Pipeline<int>()
+        .stage(source, [](int value){return value;})
+        .stage(stuck, [opened](int value) mutable
+        {
+            opened.wait();
+            return value;
+        }, 1);
+
+    NSA::Future<int> first = line.push(0);
+    NSA::Future<int> second = line.push(1);
+    bool failed = false;
+
+    try
+    {
+        second.get();
+    }
+    catch (const NSA::Overloaded &)
+    {
+        failed = true;
+    }
+
+    gate.set_value();
+
+    const bool passed = failed && first.get() == 0;
+
+    source.join();
+    stuck.join();
+
+    return passed;
+}
+
+/**
+ * @brief The exception of a stage ends up in the future, and skips the
+ *        stages after it.
+ */
+static bool failing()
+{
+    NSA::Service first("First service"), second("Second service");
+    first.detach();
+    second.detach();
+
+    std::atomic<int> reached(0);
+
+    auto line = NSA::Pipeline<int>()
+        .stage(first, [](int value)
+        {
+            if (value % 2)
+                throw std::invalid_argument("odd");
+
+            return value;
+        }, 2)
+        .stage(second, [&reached](int){reached++;}, 0, NSA::Fusion::Inline);
+
+    int failed = 0;
+
+    for (int i = 0; i < 10; i++)
+    {
+        NSA::Future<void> future = line.push(i);
+
+        try
+        {
+            future.get();
+        }
+        catch (const std::invalid_argument &)
+        {
+            failed++;
+        }
+    }
+
+    first.join();
+    second.join();
+
+    // A stopped service does not take the element.
+    NSA::Future<void> late = line.push(0);
+
+    try
+    {
+        late.get();
+        return false;
+    }
+    catch (const NSA::Overloaded &)
+    {}
+
+    return failed == 5 && reached == 5;
+}
+
+int main(int argc, char **argv)
+{
+    if (!typed() || !fused() || !busy() || !capacity() || !stalled() || !failing())
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
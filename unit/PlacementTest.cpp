@@ -0,0 +1,106 @@
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <sched.h>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "Service.hpp"
+
+/**
+ * @brief Service which reports the CPU its worker runs on.
+ */
+class Where : public NSA::Service
+{
+public:
+    Where() : Service("Where service", 16, NSA::QueueBackend::Ring)
+    {}
+
+    Service::Future<int> cpu()
+    {
+        NSA_MAKE_PROMISE(Where::cpuImp, int);
+    }
+
+private:
+    void cpuImp(Service::Promise<int> promise)
+    {
+        promise->set_value(sched_getcpu());
+    }
+};
+
+int main(int argc, char **argv)
+{
+    const std::size_t nodes = NSA::Placement::nodes();
+    const std::vector<int> local = NSA::Placement::nodeCpus(0);
+
+    printf("%zu NUMA nodes, %zu CPUs on node 0\n", nodes, local.size());
+
+    if (nodes < 1 || local.empty())
+        return EXIT_FAILURE;
+
+    // Workers pinned to a single CPU stay there.
+    const int last = local.back();
+    Where pinned;
+    pinned.detach(2, NSA::Scheduling::SharedQueue, NSA::Placement::onCpus({last}));
+
+    for (int i = 0; i < 100; i++)
+    {
+        if (pinned.cpu().get() != last)
+        {
+            printf("Worker left CPU %d\n", last);
+            return EXIT_FAILURE;
+        }
+    }
+
+    pinned.join();
+
+    // A node placement keeps the workers on the node and the job list
+    // usable after it was moved.
+    Where node;
+    node.detach(1, NSA::Scheduling::WorkStealing, NSA::Placement::onNode(0));
+
+    for (int i = 0; i < 100; i++)
+    {
+        const int cpu = node.cpu().get();
+
+        if (std::find(local.begin(), local.end(), cpu) == local.end())
+            return EXIT_FAILURE;
+    }
+
+    node.join();
+
+    // A node which does not exist leaves the workers unpinned.
+    const NSA::Placement missing = NSA::Placement::onNode(static_cast<int>(nodes) + 1000);
+
+    if (missing.pinned() || missing.node() >= 0)
+        return EXIT_FAILURE;
+
+    Where anywhere;
+    anywhere.detach(1, NSA::Scheduling::SharedQueue, missing);
+    anywhere.cpu().get();
+    anywhere.join();
+
+    // A memory scope brings back the policy the thread had before.
+    const unsigned long interleaved = 1;
+
+    if (syscall(SYS_set_mempolicy, MPOL_INTERLEAVE, &interleaved, 8 * sizeof(interleaved)) == 0)
+    {
+        {
+            NSA::NodeMemoryScope scope(0);
+        }
+
+        int mode = -1;
+        unsigned long policyNodes[16] = {};
+
+        if (syscall(SYS_get_mempolicy, &mode, policyNodes, 8 * sizeof(policyNodes), nullptr, 0) != 0
+            || mode != MPOL_INTERLEAVE || policyNodes[0] != interleaved)
+        {
+            printf("Memory policy was not restored\n");
+            return EXIT_FAILURE;
+        }
+
+        syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+    }
+
+    return EXIT_SUCCESS;
+}
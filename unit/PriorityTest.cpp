@@ -0,0 +1,163 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include "Service.hpp"
+
+/**
+ * @brief Service which records the order its jobs run in.
+ */
+class Recorder : public NSA::Service
+{
+public:
+    Recorder() : Service("Recorder service")
+    {}
+
+    /**
+     * @brief Keeps the single worker busy until the gate opens.
+     */
+    Service::Future<void> block(NSA::Future<void> gate)
+    {
+        NSA_MAKE_PROMISE(Recorder::blockImp, void, gate);
+    }
+
+    Service::Future<void> record(const NSA::Priority priority, const int tag)
+    {
+        NSA_MAKE_PRIORITY_PROMISE(priority, Recorder::recordImp, void, tag);
+    }
+
+    std::vector<int> order;
+
+private:
+    void blockImp(Service::Promise<void> promise, NSA::Future<void> gate)
+    {
+        gate.wait();
+        promise->set_value();
+    }
+
+    void recordImp(Service::Promise<void> promise, const int tag)
+    {
+        order.push_back(tag);
+        promise->set_value();
+    }
+};
+
+/**
+ * @brief Queues lowCount low and highCount high priority jobs behind
+ *        a blocked worker and returns the order they ran in. Low jobs
+ *        are tagged negative.
+ */
+static std::vector<int> run(const int lowCount, const int highCount)
+{
+    Recorder recorder;
+    recorder.detach();
+
+    NSA::Promise<void> gate;
+    std::vector<NSA::Future<void>> jobs;
+    jobs.push_back(recorder.block(gate.get_future()));
+
+    for (int i = 1; i <= lowCount; i++)
+        jobs.push_back(recorder.record(NSA::Priority::Low, -i));
+
+    for (int i = 1; i <= highCount; i++)
+        jobs.push_back(recorder.record(NSA::Priority::High, i));
+
+    gate.set_value();
+
+    for (NSA::Future<void> &job : jobs)
+        job.get();
+
+    recorder.join();
+
+    return recorder.order;
+}
+
+int main(int argc, char **argv)
+{
+    // High priority jobs overtake the low priority ones queued before.
+    std::vector<int> order = run(20, 5);
+
+    for (int i = 0; i < 5; i++)
+    {
+        if (order[i] <= 0)
+        {
+            printf("Low priority job ran before a high priority one\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // A busy high lane does not starve the low lane.
+    order = run(10, 100);
+    std::size_t firstLow = order.size();
+
+    for (std::size_t i = 0; i < order.size(); i++)
+    {
+        if (order[i] < 0)
+        {
+            firstLow = i;
+            break;
+        }
+    }
+
+    printf("First low priority job ran at position %zu of %zu\n", firstLow, order.size());
+
+    if (firstLow > 20)
+        return EXIT_FAILURE;
+
+    // A full low lane does not block high priority callers. A caller
+    // which waited for room would time out, like the third low job.
+    Recorder narrow;
+    narrow.jobLimit(NSA::Priority::Low, 2);
+    narrow.jobTimeOut(std::chrono::milliseconds(5));
+    narrow.detach();
+
+    NSA::Promise<void> gate;
+    std::vector<NSA::Future<void>> jobs;
+    jobs.push_back(narrow.block(gate.get_future()));
+
+    while (narrow.currentJobs() != 0)
+        std::this_thread::yield();
+
+    jobs.push_back(narrow.record(NSA::Priority::Low, -1));
+    jobs.push_back(narrow.record(NSA::Priority::Low, -2));
+    narrow.record(NSA::Priority::Low, -3);
+
+    for (int i = 1; i <= 50; i++)
+        jobs.push_back(narrow.record(NSA::Priority::High, i));
+
+    // Everything is queued before the worker takes the first job.
+    const std::size_t queued = narrow.currentJobs();
+    gate.set_value();
+
+    std::size_t done = 0;
+
+    for (NSA::Future<void> &job : jobs)
+    {
+        try
+        {
+            job.get();
+            done++;
+        }
+        catch (const NSA::Overloaded &)
+        {}
+    }
+
+    narrow.join();
+
+#if NSA_METRICS_ENABLED
+    if (narrow.metrics().timeouts != 1)
+    {
+        printf("%zu callers timed out instead of the full low lane\n", narrow.metrics().timeouts);
+        return EXIT_FAILURE;
+    }
+#endif
+
+    if (queued != 52 || done != jobs.size() || narrow.order.size() != 52)
+    {
+        printf("High priority callers were blocked by the low lane\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,195 @@
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "Service.hpp"
+
+/// Counts every allocation of the process.
+static std::atomic<std::size_t> allocations(0);
+
+void *operator new(std::size_t size)
+{
+    allocations++;
+
+    if (void *memory = std::malloc(size))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+class Echo : public NSA::Service
+{
+public:
+    Echo() : Service("Echo service", 64, NSA::QueueBackend::Ring)
+    {
+        jobTimeOut(std::chrono::milliseconds(60000));
+    }
+
+    Service::Future<std::size_t> length(const std::string text)
+    {
+        NSA_MAKE_PROMISE(Echo::lengthImp, std::size_t, text);
+    }
+
+    Service::Future<void> fail()
+    {
+        NSA_MAKE_PROMISE(Echo::failImp, void);
+    }
+
+    Service::Future<void> forget()
+    {
+        NSA_MAKE_PROMISE(Echo::forgetImp, void);
+    }
+
+private:
+    void lengthImp(Service::Promise<std::size_t> promise, const std::string text)
+    {
+        promise->set_value(text.size());
+    }
+
+    void failImp(Service::Promise<void> promise)
+    {
+        promise->set_exception(std::make_exception_ptr(std::runtime_error("failed")));
+    }
+
+    void forgetImp(Service::Promise<void>)
+    {}
+};
+
+/// Value type of a promise, a type of its own for every N.
+template <std::size_t N>
+struct Sized
+{
+    char bytes[N];
+};
+
+/// Service with a lot of promise types.
+class Crowd : public NSA::Service
+{
+public:
+    Crowd() : Service("Crowd service")
+    {}
+
+    template <std::size_t N>
+    Service::Future<Sized<N>> make()
+    {
+        NSA_MAKE_PROMISE(Crowd::makeImp<N>, Sized<N>);
+    }
+
+private:
+    template <std::size_t N>
+    void makeImp(Service::Promise<Sized<N>> promise)
+    {
+        promise->set_value(Sized<N>());
+    }
+};
+
+/**
+ * @brief Uses more promise types than a service pools, in another service.
+ */
+template <std::size_t... N>
+static void crowd(std::index_sequence<N...>)
+{
+    Crowd crowd;
+    crowd.detach();
+
+    const int made[] = {(crowd.make<N + 1>()->get(), 0)...};
+    (void)made;
+
+    crowd.join();
+}
+
+int main(int argc, char **argv)
+{
+    NSA::Service::Future<std::size_t> late;
+
+    // The pools are per service, the types of another one do not count.
+    crowd(std::make_index_sequence<20>());
+
+    {
+        Echo echo;
+        echo.detach();
+
+        // Warm up, so the pool and the job list reached their working size.
+        for (int i = 0; i < 200; i++)
+            echo.length("warm up")->get();
+
+        const std::size_t before = allocations;
+
+        for (int i = 0; i < 1000; i++)
+        {
+            if (echo.length("Vanille")->get() != 7)
+            {
+                printf("Wrong result\n");
+                return EXIT_FAILURE;
+            }
+        }
+
+        const std::size_t used = allocations - before;
+        printf("Allocations for 1000 promise round trips: %zu\n", used);
+
+        if (used != 0)
+            return EXIT_FAILURE;
+
+        try
+        {
+            echo.fail()->get();
+            printf("Exception was not forwarded\n");
+            return EXIT_FAILURE;
+        }
+        catch (const std::runtime_error &)
+        {}
+
+        try
+        {
+            echo.forget()->get();
+            printf("Dropped promise did not break\n");
+            return EXIT_FAILURE;
+        }
+        catch (const std::future_error &error)
+        {
+            if (error.code() != std::future_errc::broken_promise)
+                return EXIT_FAILURE;
+        }
+
+        // A future may outlive its service and pool.
+        late = echo.length("late");
+        echo.join();
+    }
+
+    if (late->wait_for(std::chrono::milliseconds(0)) != std::future_status::ready || late->get() != 4)
+    {
+        printf("Future did not survive its service\n");
+        return EXIT_FAILURE;
+    }
+
+    NSA::Promise<int> promise;
+    NSA::Future<int> future = promise.get_future();
+
+    if (future->wait_for(std::chrono::milliseconds(1)) != std::future_status::timeout)
+        return EXIT_FAILURE;
+
+    promise.set_value(3);
+
+    try
+    {
+        promise.set_value(4);
+        return EXIT_FAILURE;
+    }
+    catch (const std::future_error &)
+    {}
+
+    return future.get() == 3 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
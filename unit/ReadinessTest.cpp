@@ -0,0 +1,151 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include "BlockingQueue.hpp"
+
+#define ELEMENTS 100000
+
+static bool readable(const int fd)
+{
+    pollfd entry = {fd, POLLIN, 0};
+    return poll(&entry, 1, 0) == 1 && (entry.revents & POLLIN);
+}
+
+/**
+ * @brief Checks the edges of the eventfd by hand.
+ */
+static bool edges(const NSA::QueueBackend backend)
+{
+    NSA::BlockingQueue<int> queue(64, backend);
+    const int fd = queue.readiness();
+
+    if (fd < 0 || fd != queue.readiness() || readable(fd))
+        return false;
+
+    // Three pushes, but a single write.
+    for (int i = 0; i < 3; i++)
+        queue.push(i);
+
+    if (!readable(fd))
+        return false;
+
+    std::uint64_t writes = 0;
+
+    if (read(fd, &writes, sizeof(writes)) != sizeof(writes) || writes != 1)
+    {
+        printf("%llu writes for three pushes\n", static_cast<unsigned long long>(writes));
+        return false;
+    }
+
+    // Draining comes up short and rearms the eventfd.
+    int items[8];
+
+    if (queue.tryPopBulk(items, 8) != 3 || readable(fd))
+        return false;
+
+    queue.push(3);
+
+    if (!readable(fd))
+        return false;
+
+    int item = 0;
+
+    if (!queue.tryPop(&item) || item != 3 || queue.tryPop(&item) || readable(fd))
+        return false;
+
+    // Closing wakes the event loop for good.
+    queue.close();
+
+    return readable(fd) && !queue.tryPop(&item) && readable(fd) && queue.isClosed();
+}
+
+/**
+ * @brief Elements pushed before the eventfd existed still signal it.
+ */
+static bool late()
+{
+    NSA::BlockingQueue<int> queue(8);
+    queue.push(1);
+
+    return readable(queue.readiness());
+}
+
+/**
+ * @brief Consumes a producer thread from an epoll loop.
+ */
+static bool loop(const NSA::QueueBackend backend)
+{
+    NSA::BlockingQueue<int> queue(256, backend);
+    const int events = epoll_create1(0);
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = queue.readiness();
+
+    if (events < 0 || epoll_ctl(events, EPOLL_CTL_ADD, event.data.fd, &event) != 0)
+        return false;
+
+    std::thread producer([&queue]
+    {
+        for (int i = 0; i < ELEMENTS; i++)
+            while (!queue.push(i, std::chrono::milliseconds(1000)))
+            {}
+
+        queue.close();
+    });
+
+    std::vector<int> items;
+    std::size_t wakeups = 0;
+    int expected = 0;
+    bool ordered = true;
+
+    while (!queue.isClosed() || !queue.empty())
+    {
+        if (epoll_wait(events, &event, 1, 1000) != 1)
+            break;
+
+        wakeups++;
+        items.clear();
+
+        while (queue.tryPopBulk(std::back_inserter(items), 64) == 64)
+        {}
+
+        for (const int item : items)
+            ordered = ordered && item == expected++;
+    }
+
+    producer.join();
+    close(events);
+
+    printf("%d elements in %zu wakeups\n", expected, wakeups);
+
+    return ordered && expected == ELEMENTS && wakeups <= ELEMENTS;
+}
+
+int main(int argc, char **argv)
+{
+    const NSA::QueueBackend backends[] = {NSA::QueueBackend::Locked, NSA::QueueBackend::Ring,
+        NSA::QueueBackend::Spsc};
+
+    for (const NSA::QueueBackend backend : backends)
+    {
+        if (!edges(backend))
+        {
+            printf("Wrong edges for backend %d\n", static_cast<int>(backend));
+            return EXIT_FAILURE;
+        }
+
+        if (!loop(backend))
+            return EXIT_FAILURE;
+    }
+
+    if (!late())
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include "BlockingQueue.hpp"
+
+#define PRODUCERS 8
+#define CONSUMERS 2
+#define ITEMS     20000
+
+/**
+ * @brief Element without a default constructor, which counts its live
+ *        instances.
+ */
+struct Counted
+{
+    explicit Counted(const int value) : value(value) { live++; }
+    Counted(Counted &&other) : value(other.value) { live++; }
+    Counted &operator=(Counted &&other) = default;
+    ~Counted() { live--; }
+
+    static int live;
+    int value;
+};
+
+int Counted::live = 0;
+
+/**
+ * @brief Elements are constructed on push and destroyed on pop, or
+ *        with the ring.
+ */
+static bool lifetime()
+{
+    bool kept = true;
+
+    {
+        NSA::RingBuffer<Counted> ring(4);
+
+        for (int i = 0; i < 3; i++)
+            kept = ring.tryPush(Counted(i)) && kept;
+
+        Counted dst(-1);
+        kept = ring.tryPop(dst) && dst.value == 0 && Counted::live == 3 && kept;
+    }
+
+    return kept && Counted::live == 0;
+}
+
+/**
+ * @brief Elements without a default constructor pass through every
+ *        backend of the queue.
+ */
+static bool elements(const NSA::QueueBackend backend)
+{
+    bool passed = true;
+
+    {
+        NSA::BlockingQueue<Counted> queue(4, backend);
+
+        for (int i = 0; i < 3; i++)
+            passed = queue.push(Counted(i)) && passed;
+
+        Counted dst(-1);
+        passed = queue.pop(&dst) && dst.value == 0 && passed;
+    }
+
+    return passed && Counted::live == 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (!lifetime())
+    {
+        printf("Ring did not construct and destroy its elements in place\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!elements(NSA::QueueBackend::Locked) || !elements(NSA::QueueBackend::Ring)
+        || !elements(NSA::QueueBackend::Spsc) || !elements(NSA::QueueBackend::Ordered))
+    {
+        printf("Queue of elements without a default constructor failed\n");
+        return EXIT_FAILURE;
+    }
+
+    NSA::BlockingQueue<int> queue(16, NSA::QueueBackend::Ring);
+
+    if (queue.backend() != NSA::QueueBackend::Ring)
+    {
+        printf("Ring backend was not selected\n");
+        return EXIT_FAILURE;
+    }
+
+    NSA::BlockingQueue<int> tiny(1, NSA::QueueBackend::Ring);
+
+    if (tiny.backend() != NSA::QueueBackend::Locked)
+    {
+        printf("A queue of one element has to fall back to the locked backend\n");
+        return EXIT_FAILURE;
+    }
+
+    // Every producer pushes the values 1..ITEMS. The consumers sum up
+    // what they get, so lost or duplicated elements show up in the sum.
+    std::atomic<long long> sum(0);
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < PRODUCERS; p++)
+        threads.push_back(std::thread([&]()
+        {
+            for (int i = 1; i <= ITEMS; i++)
+                queue.push(i, std::chrono::milliseconds(60000));
+        }));
+
+    for (int c = 0; c < CONSUMERS; c++)
+        threads.push_back(std::thread([&]()
+        {
+            for (int i = 0; i < PRODUCERS * ITEMS / CONSUMERS; i++)
+            {
+                int dst = 0;
+                queue.pop(&dst);
+                sum += dst;
+            }
+        }));
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    const long long expected = static_cast<long long>(PRODUCERS) * ITEMS * (ITEMS + 1) / 2;
+    printf("Consumed sum %lld, expected %lld\n", sum.load(), expected);
+
+    if (sum != expected || !queue.empty())
+        return EXIT_FAILURE;
+
+    // A full ring has to time out instead of overwriting.
+    NSA::BlockingQueue<int> full(2, NSA::QueueBackend::Ring);
+    full.push(1);
+    full.push(2);
+
+    if (full.push(3, std::chrono::milliseconds(10)) || full.size() != 2)
+    {
+        printf("Push into a full ring did not time out\n");
+        return EXIT_FAILURE;
+    }
+
+    int first = 0;
+    full.pop(&first);
+
+    if (first != 1)
+    {
+        printf("Ring is not FIFO\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,159 @@
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "Select.hpp"
+
+#define PRODUCERS   3
+#define ELEMENTS    20000
+
+/**
+ * @brief Checks which queue serves a pop, with all queues filled.
+ */
+static bool fairness()
+{
+    NSA::BlockingQueue<int> a(16), b(16), c(16);
+    NSA::Select<int> select({&a, &b, &c});
+    int item = 0;
+
+    if (select.tryPop(&item) != NSA::Select<int>::None)
+        return false;
+
+    b.push(1);
+
+    if (select.pop(&item) != 1 || item != 1)
+        return false;
+
+    for (int i = 0; i < 4; i++)
+    {
+        a.push(i);
+        b.push(i);
+        c.push(i);
+    }
+
+    // A round robin over the queues, not the first queue until it is empty.
+    for (int i = 0; i < 12; i++)
+    {
+        const std::size_t index = select.pop(&item, std::chrono::milliseconds(10));
+
+        if (index != static_cast<std::size_t>((i + 2) % 3) || item != i / 3)
+        {
+            printf("Pop %d came from queue %zu\n", i, index);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief An empty select gives up after the timeout.
+ */
+static bool timeout()
+{
+    NSA::BlockingQueue<int> a(16), b(16);
+    NSA::Select<int> select({&a, &b});
+    int item = 0;
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if (select.pop(&item, std::chrono::milliseconds(20)) != NSA::Select<int>::None)
+        return false;
+
+    return std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20);
+}
+
+/**
+ * @brief A queue with a readiness eventfd works with a select, whose
+ *        pops rearm that eventfd.
+ */
+static bool readiness()
+{
+    NSA::BlockingQueue<int> a(16), b(16);
+
+    if (a.readiness() < 0)
+        return true;
+
+    NSA::Select<int> select({&a, &b});
+    int item = 0;
+
+    a.push(1);
+    b.push(2);
+
+    if (select.pop(&item, std::chrono::milliseconds(100)) != 0 || item != 1
+        || select.pop(&item, std::chrono::milliseconds(100)) != 1 || item != 2)
+        return false;
+
+    a.close();
+    b.close();
+
+    return select.pop(&item, std::chrono::milliseconds(100)) == NSA::Select<int>::None
+        && select.pop(&item) == NSA::Select<int>::None;
+}
+
+/**
+ * @brief One consumer thread serves several producers, each with a queue.
+ */
+template <class Wait>
+static bool producers(const NSA::QueueBackend backend)
+{
+    std::vector<std::unique_ptr<NSA::BlockingQueue<int, Wait>>> queues;
+    std::vector<NSA::BlockingQueue<int, Wait> *> pointers;
+
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        queues.emplace_back(new NSA::BlockingQueue<int, Wait>(64, backend));
+        pointers.push_back(queues.back().get());
+    }
+
+    NSA::Select<int, Wait> select(pointers);
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < PRODUCERS; p++)
+        threads.push_back(std::thread([&queues, p]
+        {
+            for (int i = 0; i < ELEMENTS; i++)
+                while (!queues[p]->push(i, std::chrono::milliseconds(1000)))
+                {}
+
+            queues[p]->close();
+        }));
+
+    int expected[PRODUCERS] = {0};
+    int item = 0;
+    std::size_t index = 0;
+
+    // Every queue keeps its own order.
+    while ((index = select.pop(&item)) != NSA::Select<int, Wait>::None)
+        if (item != expected[index]++)
+            return false;
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    for (int p = 0; p < PRODUCERS; p++)
+        if (expected[p] != ELEMENTS)
+            return false;
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (!fairness() || !timeout() || !readiness())
+        return EXIT_FAILURE;
+
+    const NSA::QueueBackend backends[] = {NSA::QueueBackend::Locked, NSA::QueueBackend::Ring,
+        NSA::QueueBackend::Spsc};
+
+    for (const NSA::QueueBackend backend : backends)
+    {
+        if (!producers<NSA::BlockingWait>(backend) || !producers<NSA::SpinFutexWait>(backend))
+        {
+            printf("Lost elements with backend %d\n", static_cast<int>(backend));
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
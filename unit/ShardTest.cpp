@@ -0,0 +1,220 @@
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "PriorityLanes.hpp"
+#include "Service.hpp"
+
+#define SHARDS      4
+#define PRODUCERS   8
+#define LIMIT       16
+#define JOBS        20000
+
+/**
+ * @brief Service with a sharded job list.
+ */
+class Hot : public NSA::Service
+{
+public:
+    Hot(const NSA::QueueBackend backend, const NSA::Overflow policy) : Service("Hot service", LIMIT, backend),
+        served(0)
+    {
+        jobShards(SHARDS);
+        jobOverflow(policy);
+        jobTimeOut(std::chrono::milliseconds(5000));
+    }
+
+    /**
+     * @brief Keeps the single worker busy until the gate opens.
+     */
+    Service::Future<void> block(NSA::Future<void> gate)
+    {
+        NSA_MAKE_PROMISE(Hot::blockImp, void, gate);
+    }
+
+    Service::Future<void> serve()
+    {
+        NSA_MAKE_PROMISE(Hot::serveImp, void);
+    }
+
+    std::atomic<std::size_t> served;
+
+private:
+    void blockImp(Service::Promise<void> promise, NSA::Future<void> gate)
+    {
+        gate.wait();
+        promise->set_value();
+    }
+
+    void serveImp(Service::Promise<void> promise)
+    {
+        served++;
+        promise->set_value();
+    }
+};
+
+/**
+ * @brief The top of a sharded lane holds for all shards together.
+ */
+static bool lanes(const NSA::QueueBackend backend)
+{
+    NSA::PriorityLanes<int> lanes(LIMIT, backend);
+    lanes.shard(SHARDS);
+
+    std::atomic<std::size_t> pushed(0);
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < PRODUCERS; p++)
+        producers.push_back(std::thread([&lanes, &pushed, p]
+        {
+            for (int i = 0; i < LIMIT; i++)
+                if (lanes.tryPush(NSA::Priority::Normal, p * LIMIT + i))
+                    pushed++;
+        }));
+
+    for (std::thread &producer : producers)
+        producer.join();
+
+    if (pushed != LIMIT || lanes.size() != LIMIT)
+    {
+        printf("%zu pushed, %zu queued\n", pushed.load(), lanes.size());
+        return false;
+    }
+
+    // Room comes back as soon as an element leaves any shard.
+    NSA::PriorityLanes<int>::Cursor cursor;
+    int item = 0;
+
+    if (!lanes.tryPop(cursor, &item) || !lanes.tryPush(NSA::Priority::Normal, -1)
+        || lanes.tryPush(NSA::Priority::Normal, -2))
+        return false;
+
+    std::vector<int> items;
+
+    while (lanes.tryPopBulk(cursor, std::back_inserter(items), 4) > 0)
+    {}
+
+    return items.size() == LIMIT && lanes.empty();
+}
+
+/**
+ * @brief Many callers of a sharded service, while the queued jobs never
+ *        exceed the job limit.
+ */
+static bool service(const NSA::QueueBackend backend)
+{
+    Hot hot(backend, NSA::Overflow::Block);
+    hot.detach(2);
+
+    std::atomic<bool> done(false);
+    std::size_t peak = 0;
+
+    std::thread sampler([&hot, &done, &peak]
+    {
+        while (!done)
+            peak = std::max(peak, hot.currentJobs());
+    });
+
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < PRODUCERS; p++)
+        producers.push_back(std::thread([&hot]
+        {
+            for (int i = 0; i < JOBS / PRODUCERS; i++)
+                hot.serve();
+        }));
+
+    for (std::thread &producer : producers)
+        producer.join();
+
+    hot.join();
+    done = true;
+    sampler.join();
+
+    printf("%zu jobs served, at most %zu queued\n", hot.served.load(), peak);
+
+    // Each of the three lanes may hold LIMIT jobs, only Normal is used.
+    return hot.served == JOBS && peak <= LIMIT && hot.currentJobs() == 0;
+}
+
+/**
+ * @brief The overflow policies see the whole lane as full.
+ */
+static bool overflow(const NSA::Overflow policy)
+{
+    Hot hot(NSA::QueueBackend::Locked, policy);
+    hot.detach();
+
+    NSA::Promise<void> gate;
+    NSA::Future<void> busy = hot.block(gate.get_future());
+
+    while (hot.currentJobs() != 0)
+        std::this_thread::yield();
+
+    std::vector<NSA::Future<void>> futures;
+    std::vector<std::thread> producers;
+    std::mutex futuresMutex;
+
+    for (int p = 0; p < PRODUCERS; p++)
+        producers.push_back(std::thread([&hot, &futures, &futuresMutex]
+        {
+            for (int i = 0; i < LIMIT; i++)
+            {
+                NSA::Future<void> future = hot.serve();
+                std::lock_guard<std::mutex> lock(futuresMutex);
+                futures.push_back(future);
+            }
+        }));
+
+    for (std::thread &producer : producers)
+        producer.join();
+
+    const std::size_t queued = hot.currentJobs();
+    const NSA::MetricsSnapshot metrics = hot.metrics();
+
+    gate.set_value();
+    hot.join();
+
+    std::size_t failed = 0;
+
+    for (NSA::Future<void> &future : futures)
+    {
+        try
+        {
+            future.get();
+        }
+        catch (const NSA::Overloaded &)
+        {
+            failed++;
+        }
+    }
+
+    printf("%zu queued, %zu failed\n", queued, failed);
+
+    return queued == LIMIT && failed == PRODUCERS * LIMIT - LIMIT && hot.served == LIMIT
+        && (!NSA_METRICS_ENABLED || metrics.overflows == failed);
+}
+
+int main(int argc, char **argv)
+{
+    const NSA::QueueBackend backends[] = {NSA::QueueBackend::Locked, NSA::QueueBackend::Ring,
+        NSA::QueueBackend::Ordered};
+
+    for (const NSA::QueueBackend backend : backends)
+        if (!lanes(backend) || !service(backend))
+            return EXIT_FAILURE;
+
+    if (!overflow(NSA::Overflow::Reject) || !overflow(NSA::Overflow::DropOldest))
+        return EXIT_FAILURE;
+
+    // A Spsc job list has a single producer, so it does not shard.
+    NSA::PriorityLanes<int> spsc(LIMIT, NSA::QueueBackend::Spsc);
+    spsc.shard(SHARDS);
+
+    if (spsc.shardCount() != 1)
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
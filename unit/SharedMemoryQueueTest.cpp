@@ -0,0 +1,290 @@
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Service.hpp"
+#include "SharedMemoryQueue.hpp"
+
+#define PRODUCERS 2
+#define ELEMENTS 20000
+
+/// Element type, as another process would submit it.
+struct Order
+{
+    int producer;
+    int number;
+    char note[24];
+};
+
+/**
+ * @brief A name no other run of the test uses.
+ */
+static std::string segment(const char *test)
+{
+    return "/nsa-" + std::string(test) + "-" + std::to_string(getpid());
+}
+
+/**
+ * @brief Waits for a child and checks it exited cleanly.
+ */
+static bool reap(const pid_t child)
+{
+    int status = 0;
+
+    return child > 0 && waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+
+/**
+ * @brief FIFO order, the top, in place slots and closing in a single
+ *        process.
+ */
+static bool single()
+{
+    const std::string name = segment("single");
+    NSA::SharedMemoryQueue<Order> queue;
+
+    if (!queue.create(name, 5) || queue.max() != 8 || !queue.empty())
+        return false;
+
+    for (int i = 0; i < 8; i++)
+        if (!queue.tryPush(Order{0, i, "push"}))
+            return false;
+
+    if (queue.tryPush(Order{0, 8, "full"}) || queue.push(Order{0, 8, "full"}, std::chrono::milliseconds(10)))
+        return false;
+
+    Order order;
+
+    for (int i = 0; i < 4; i++)
+        if (!queue.tryPop(&order) || order.number != i)
+            return false;
+
+    // Filled and read in place.
+    Order *slot = queue.tryReserve();
+
+    if (!slot)
+        return false;
+
+    slot->number = 8;
+    queue.commit(slot);
+
+    for (int i = 4; i < 9; i++)
+    {
+        const Order *read = queue.tryAcquire();
+
+        if (!read || read->number != i)
+            return false;
+
+        queue.release(read);
+    }
+
+    queue.push(Order{0, 9, "last"});
+    queue.close();
+
+    const bool closed = !queue.tryPush(Order{0, 10, "late"}) && queue.pop(&order) && order.number == 9
+        && !queue.pop(&order) && queue.recovered() == 0;
+
+    NSA::SharedMemoryQueue<Order> again;
+
+    // The name is taken, so create opens the same queue.
+    const bool shared = again.create(name, 64) && again.max() == 8 && again.isClosed();
+
+    NSA::SharedMemoryQueue<Order>::remove(name);
+
+    NSA::SharedMemoryQueue<Order> gone;
+
+    return closed && shared && !gone.open(name, std::chrono::milliseconds(0));
+}
+
+/**
+ * @brief Producer processes submit orders to a service of this process.
+ */
+static bool processes()
+{
+    const std::string name = segment("processes");
+    NSA::SharedMemoryQueue<Order> queue;
+
+    if (!queue.create(name, 64))
+        return false;
+
+    pid_t children[PRODUCERS];
+
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        children[p] = fork();
+
+        if (children[p] == 0)
+        {
+            NSA::SharedMemoryQueue<Order> orders;
+
+            if (!orders.open(name))
+                _exit(EXIT_FAILURE);
+
+            for (int i = 0; i < ELEMENTS; i++)
+                while (!orders.push(Order{p, i, "order"}, std::chrono::milliseconds(1000)))
+                {}
+
+            _exit(EXIT_SUCCESS);
+        }
+    }
+
+    NSA::Service kitchen("Kitchen service");
+    kitchen.detach(2);
+
+    std::atomic<long> sum(0);
+    std::atomic<int> cooked(0);
+    int next[PRODUCERS] = {};
+    bool ordered = true;
+
+    // A single popping thread sees every producer in order.
+    std::thread bridge([&]
+    {
+        Order order;
+
+        while (queue.pop(&order))
+        {
+            ordered = ordered && order.number == next[order.producer]++;
+
+            kitchen.post(NSA::Job([&sum, &cooked, order]
+            {
+                sum += order.number;
+                cooked++;
+            }));
+        }
+    });
+
+    bool exited = true;
+
+    for (const pid_t child : children)
+        exited = reap(child) && exited;
+
+    queue.close();
+    bridge.join();
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+    while (cooked < PRODUCERS * ELEMENTS && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    kitchen.join();
+    NSA::SharedMemoryQueue<Order>::remove(name);
+
+    printf("%d orders cooked\n", cooked.load());
+
+    return exited && ordered && cooked == PRODUCERS * ELEMENTS
+        && sum == PRODUCERS * (static_cast<long>(ELEMENTS) * (ELEMENTS - 1) / 2);
+}
+
+/**
+ * @brief A producer dies with a reserved slot, the consumers skip it.
+ */
+static bool deadProducer()
+{
+    const std::string name = segment("producer");
+    NSA::SharedMemoryQueue<Order> queue;
+
+    if (!queue.create(name, 8))
+        return false;
+
+    const pid_t child = fork();
+
+    if (child == 0)
+    {
+        NSA::SharedMemoryQueue<Order> orders;
+        _exit(orders.open(name) && orders.tryReserve() ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    if (!reap(child) || queue.size() != 1)
+        return false;
+
+    queue.push(Order{0, 1, "behind"});
+
+    Order order;
+    const bool skipped = queue.pop(&order, std::chrono::milliseconds(1000)) && order.number == 1
+        && queue.recovered() == 1 && queue.empty();
+
+    NSA::SharedMemoryQueue<Order>::remove(name);
+
+    return skipped;
+}
+
+/**
+ * @brief A consumer dies with an acquired slot, the producers get it
+ *        back once they come around.
+ */
+static bool deadConsumer()
+{
+    const std::string name = segment("consumer");
+    NSA::SharedMemoryQueue<Order> queue;
+
+    if (!queue.create(name, 4))
+        return false;
+
+    for (int i = 0; i < 4; i++)
+        queue.push(Order{0, i, "first lap"});
+
+    const pid_t child = fork();
+
+    if (child == 0)
+    {
+        NSA::SharedMemoryQueue<Order> orders;
+        const Order *slot = orders.open(name) ? orders.tryAcquire() : nullptr;
+        _exit(slot && slot->number == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    if (!reap(child))
+        return false;
+
+    Order order;
+
+    for (int i = 1; i < 4; i++)
+        if (!queue.pop(&order, std::chrono::milliseconds(10)) || order.number != i)
+            return false;
+
+    // The second lap needs the slot the child died with.
+    for (int i = 0; i < 4; i++)
+        if (!queue.push(Order{0, 4 + i, "second lap"}, std::chrono::milliseconds(1000)))
+            return false;
+
+    bool lapped = queue.recovered() == 1;
+
+    for (int i = 0; i < 4; i++)
+        lapped = lapped && queue.tryPop(&order) && order.number == 4 + i;
+
+    NSA::SharedMemoryQueue<Order>::remove(name);
+
+    return lapped;
+}
+
+int main(int argc, char **argv)
+{
+    if (!single())
+    {
+        printf("Single process queue failed\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!processes())
+    {
+        printf("Queue between processes failed\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!deadProducer())
+    {
+        printf("Slot of a dead producer was not skipped\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!deadConsumer())
+    {
+        printf("Slot of a dead consumer was not recovered\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
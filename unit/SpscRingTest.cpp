@@ -0,0 +1,178 @@
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "BlockingQueue.hpp"
+
+#define ROUNDTRIPS 20000
+
+/**
+ * @brief Measures the handoff latency of a backend.
+ * @details Two threads bounce a counter through a pair of queues. Every
+ *          round trip consists of two hops, so the per-hop latency is
+ *          the total duration divided by twice the round trips.
+ *
+ * @param backend The backend under test.
+ * @param nsPerHop The measured average latency of a single hop.
+ * @return True if every value arrived in order.
+ */
+bool measureHandoff(const NSA::QueueBackend backend, double &nsPerHop)
+{
+    NSA::BlockingQueue<int> forth(8, backend);
+    NSA::BlockingQueue<int> back(8, backend);
+    bool ordered = true;
+
+    std::thread echo([&]()
+    {
+        int value = 0;
+
+        for (int i = 0; i < ROUNDTRIPS; i++)
+        {
+            forth.pop(&value);
+            back.push(value + 1);
+        }
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < ROUNDTRIPS; i++)
+    {
+        int value = 0;
+        forth.push(2 * i);
+        back.pop(&value);
+
+        if (value != 2 * i + 1)
+            ordered = false;
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    echo.join();
+
+    nsPerHop = std::chrono::duration<double, std::nano>(end - start).count() / (2.0 * ROUNDTRIPS);
+    return ordered;
+}
+
+/**
+ * @brief Element without a default constructor, which counts its live
+ *        instances.
+ */
+struct Counted
+{
+    explicit Counted(const int value) : value(value) { live++; }
+    Counted(Counted &&other) : value(other.value) { live++; }
+    Counted &operator=(Counted &&other) = default;
+    ~Counted() { live--; }
+
+    static int live;
+    int value;
+};
+
+int Counted::live = 0;
+
+/**
+ * @brief Elements are constructed on push and destroyed on pop, or
+ *        with the ring.
+ */
+static bool lifetime()
+{
+    bool kept = true;
+
+    {
+        NSA::SpscRing<Counted> ring(4);
+
+        for (int i = 0; i < 3; i++)
+            kept = ring.tryPush(Counted(i)) && kept;
+
+        Counted dst(-1);
+        kept = ring.tryPop(dst) && dst.value == 0 && Counted::live == 3 && kept;
+    }
+
+    return kept && Counted::live == 0;
+}
+
+/**
+ * @brief A second producer trips the assert of a debug build.
+ * @return True if a child process which pushes from two threads aborts.
+ */
+static bool secondProducer()
+{
+#ifndef NDEBUG
+    const pid_t child = fork();
+
+    if (child == 0)
+    {
+        NSA::SpscRing<int> ring(4);
+        ring.tryPush(1);
+
+        std::thread second([&ring]{ring.tryPush(2);});
+        second.join();
+
+        _exit(EXIT_SUCCESS);
+    }
+
+    int status = 0;
+
+    return child > 0 && waitpid(child, &status, 0) == child && WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+#else
+    return true;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+    if (!lifetime())
+    {
+        printf("Ring did not construct and destroy its elements in place\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!secondProducer())
+    {
+        printf("Second producer was not caught\n");
+        return EXIT_FAILURE;
+    }
+
+    NSA::BlockingQueue<int> single(1, NSA::QueueBackend::Spsc);
+
+    if (single.backend() != NSA::QueueBackend::Spsc)
+    {
+        printf("Spsc backend was not selected\n");
+        return EXIT_FAILURE;
+    }
+
+    double lockedLatency = 0;
+    double spscLatency = 0;
+
+    if (!measureHandoff(NSA::QueueBackend::Locked, lockedLatency) ||
+        !measureHandoff(NSA::QueueBackend::Spsc, spscLatency))
+    {
+        printf("Handoff lost the order of the elements\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("Per hop handoff latency. Locked: %.0f ns, Spsc: %.0f ns\n", lockedLatency, spscLatency);
+
+    // Closing wakes a parked consumer.
+    bool popped = false;
+
+    std::thread consumer([&]()
+    {
+        int dst = 0;
+        popped = single.pop(&dst);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    single.close();
+    consumer.join();
+
+    if (popped)
+    {
+        printf("Pop on a closed and empty queue succeeded\n");
+        return EXIT_FAILURE;
+    }
+
+    return single.push(1) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
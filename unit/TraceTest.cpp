@@ -0,0 +1,173 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include "Service.hpp"
+
+#define REQUESTS 100
+
+/// Looks up what the front asks for, and tells under which trace it ran.
+class Back : public NSA::Service
+{
+public:
+    Back() : Service("Back service")
+    {}
+
+    Service::Future<std::uint64_t> lookup()
+    {
+        NSA_MAKE_PROMISE(Back::lookupImp, std::uint64_t);
+    }
+
+private:
+    void lookupImp(Service::Promise<std::uint64_t> promise)
+    {
+        promise->set_value(NSA::Trace::current());
+    }
+};
+
+/// Takes the requests and asks the back for every one of them.
+class Front : public NSA::Service
+{
+public:
+    explicit Front(Back &back) : Service("Front service"), back(back)
+    {}
+
+    /// The first trace id is that of the front, the second that of the back.
+    typedef std::pair<std::uint64_t, std::uint64_t> Traces;
+
+    Service::Future<Traces> request()
+    {
+        NSA_MAKE_PROMISE(Front::requestImp, Traces);
+    }
+
+private:
+    void requestImp(Service::Promise<Traces> promise)
+    {
+        const std::uint64_t trace = NSA::Trace::current();
+        promise->set_value(Traces(trace, back.lookup()->get()));
+    }
+
+    Back &back;
+};
+
+/**
+ * @brief Writes the trace and reads it back.
+ */
+static std::string written()
+{
+    const std::string path = "/tmp/nsa-trace-" + std::to_string(getpid()) + ".json";
+
+    if (!NSA::Trace::write(path))
+        return "";
+
+    std::ifstream file(path);
+    std::stringstream text;
+    text << file.rdbuf();
+    unlink(path.c_str());
+
+    return text.str();
+}
+
+/**
+ * @brief Sends the requests and writes the trace.
+ * @return The written trace, empty if the trace ids were wrong.
+ */
+static std::string run(const bool traced)
+{
+    Back back;
+    Front front(back);
+    back.detach(2);
+    front.detach(2);
+
+    std::set<std::uint64_t> traces;
+    bool inherited = true;
+
+    for (int i = 0; i < REQUESTS; i++)
+    {
+        const Front::Traces ids = front.request()->get();
+
+        inherited = inherited && ids.first == ids.second;
+        traces.insert(ids.first);
+    }
+
+    front.join();
+    back.join();
+
+    // Every request got a trace of its own, the back inherited it.
+    const bool expected = traced ? inherited && traces.size() == REQUESTS && !traces.count(0)
+        : traces.size() == 1 && traces.count(0);
+
+    if (!expected)
+    {
+        printf("%zu traces for %d requests\n", traces.size(), REQUESTS);
+        return "";
+    }
+
+    return written();
+}
+
+/**
+ * @brief Counts how often a part occurs in a text.
+ */
+static std::size_t count(const std::string &text, const std::string &part)
+{
+    std::size_t found = 0;
+
+    for (std::size_t at = text.find(part); at != std::string::npos; at = text.find(part, at + 1))
+        found++;
+
+    return found;
+}
+
+int main(int argc, char **argv)
+{
+    if (NSA::Trace::enabled())
+        return EXIT_FAILURE;
+
+    NSA::Trace::start();
+
+    const std::string traced = run(true);
+    const std::size_t slices = count(traced, "\"ph\": \"X\"");
+
+    // A slice and a flow per job, each job on both services.
+    if (slices != 2 * REQUESTS || count(traced, "\"ph\": \"s\"") != 2 * REQUESTS
+        || count(traced, "\"name\": \"Front service\", \"cat\": \"job\"") != REQUESTS
+        || count(traced, "\"name\": \"Back service\", \"cat\": \"job\"") != REQUESTS
+        || count(traced, "\"traceEvents\": [") != 1)
+    {
+        printf("Trace with %zu slices is wrong\n", slices);
+        return EXIT_FAILURE;
+    }
+
+    // Names are escaped, so the file stays valid JSON.
+    {
+        NSA::Service odd("Odd \"service\" \\\n");
+        odd.detach();
+        odd.post(NSA::Job([]{}));
+        odd.join();
+    }
+
+    if (count(written(), "\"name\": \"Odd \\\"service\\\" \\\\\\u000a\", \"cat\": \"job\"") != 1)
+    {
+        printf("Service name was not escaped\n");
+        return EXIT_FAILURE;
+    }
+
+    NSA::Trace::stop();
+    NSA::Trace::clear();
+
+    // Stopped, nothing is recorded.
+    const std::string untraced = run(false);
+
+    if (untraced.empty() || count(untraced, "\"ph\": \"X\"") != 0)
+    {
+        printf("Stopped trace recorded jobs\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
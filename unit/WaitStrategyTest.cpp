@@ -0,0 +1,138 @@
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "BlockingQueue.hpp"
+
+#define PRODUCERS 2
+#define CONSUMERS 2
+
+/**
+ * @brief Moves items values from PRODUCERS to CONSUMERS threads.
+ * @return True if every value arrived exactly once.
+ */
+template <class Wait>
+bool transfer(const NSA::QueueBackend backend, const int items)
+{
+    const bool single = backend == NSA::QueueBackend::Spsc;
+    const int producers = single ? 1 : PRODUCERS;
+    const int consumers = single ? 1 : CONSUMERS;
+
+    NSA::BlockingQueue<int, Wait> queue(8, backend);
+    std::atomic<long long> sum(0);
+    std::atomic<int> received(0);
+    std::vector<std::thread> threads;
+
+    for (int c = 0; c < consumers; c++)
+        threads.push_back(std::thread([&]
+        {
+            int value = 0;
+
+            while (queue.pop(&value))
+            {
+                sum += value;
+                received++;
+            }
+        }));
+
+    std::vector<std::thread> senders;
+
+    for (int p = 0; p < producers; p++)
+        senders.push_back(std::thread([&, p]
+        {
+            for (int i = 1; i <= items; i++)
+                while (!queue.push(p * items + i, std::chrono::milliseconds(1000)))
+                {}
+        }));
+
+    for (std::thread &sender : senders)
+        sender.join();
+
+    queue.close();
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    const long long all = static_cast<long long>(producers) * items;
+
+    return received == all && sum == all * (all + 1) / 2;
+}
+
+/**
+ * @brief A push into a full queue gives up after its time out, and
+ *        closing the queue releases a blocked consumer.
+ */
+template <class Wait>
+bool timeOutAndClose(const NSA::QueueBackend backend)
+{
+    NSA::BlockingQueue<int, Wait> full(2, backend);
+    full.push(1);
+    full.push(2);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    if (full.push(3, std::chrono::milliseconds(20)))
+        return false;
+
+    const auto waited = std::chrono::steady_clock::now() - start;
+
+    if (waited < std::chrono::milliseconds(20) || waited > std::chrono::seconds(2))
+        return false;
+
+    NSA::BlockingQueue<int, Wait> empty(2, backend);
+    std::atomic<bool> released(false);
+
+    std::thread consumer([&]
+    {
+        int value = 0;
+        released = !empty.pop(&value);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    empty.close();
+    consumer.join();
+
+    return released;
+}
+
+template <class Wait>
+bool check(const char *name, const int items)
+{
+    const NSA::QueueBackend backends[] = {NSA::QueueBackend::Locked, NSA::QueueBackend::Ring,
+        NSA::QueueBackend::Spsc};
+    const char *backendNames[] = {"Locked", "Ring", "Spsc"};
+
+    for (int b = 0; b < 3; b++)
+    {
+        if (!transfer<Wait>(backends[b], items))
+        {
+            printf("%s over %s lost values\n", name, backendNames[b]);
+            return false;
+        }
+
+        if (!timeOutAndClose<Wait>(backends[b]))
+        {
+            printf("%s over %s did not time out or close\n", name, backendNames[b]);
+            return false;
+        }
+    }
+
+    printf("%s passed\n", name);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    // Spinning threads share the cores with the ones they wait for,
+    // so the spin strategy gets fewer values on small machines.
+    const int spinItems = std::thread::hardware_concurrency() > 4 ? 20000 : 500;
+
+    if (!check<NSA::BlockingWait>("BlockingWait", 20000) ||
+        !check<NSA::SpinFutexWait>("SpinFutexWait", 20000) ||
+        !check<NSA::SpinWait>("SpinWait", spinItems))
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
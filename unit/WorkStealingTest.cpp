@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include "Service.hpp"
+
+#define DEPTH 10
+#define ROOTS 8
+
+/**
+ * @brief A service which splits each job into two smaller jobs.
+ * @details Every split is submitted from inside a worker, so it lands
+ *          in the deque of that worker and has to be stolen by the
+ *          others.
+ */
+class Splitter : public NSA::Service
+{
+public:
+    Splitter() : Service("Splitter service", 16), leaves(0)
+    {
+        jobTimeOut(std::chrono::milliseconds(60000));
+    }
+
+    Service::Future<void> split(const int depth)
+    {
+        NSA_MAKE_PROMISE(Splitter::splitImp, void, depth);
+    }
+
+    std::atomic<int> leaves;
+
+private:
+    void splitImp(Service::Promise<void> promise, const int depth)
+    {
+        if (depth == 0)
+            leaves++;
+        else
+        {
+            split(depth - 1);
+            split(depth - 1);
+        }
+
+        promise->set_value();
+    }
+};
+
+int main(int argc, char **argv)
+{
+    Splitter splitter;
+    splitter.detach(4, NSA::Scheduling::WorkStealing);
+
+    for (int i = 0; i < ROOTS; i++)
+        splitter.split(DEPTH)->get();
+
+    printf("Queued jobs after the roots finished: %zu\n", splitter.currentJobs());
+
+    // Joining stops the submission of further splits, so wait for them.
+    while (splitter.leaves != ROOTS * (1 << DEPTH))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    splitter.join();
+
+    const std::size_t expected = ROOTS * ((std::size_t(1) << (DEPTH + 1)) - 1);
+    printf("Leaves: %d, total jobs: %zu, expected jobs: %zu\n",
+        splitter.leaves.load(), splitter.totalJobs(), expected);
+
+    if (splitter.leaves != ROOTS * (1 << DEPTH) || splitter.totalJobs() != expected ||
+        splitter.currentJobs() != 0)
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}